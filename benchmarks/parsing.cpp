@@ -1,24 +1,148 @@
 #include "Parsing.h"
 
 #include "TrajectoryData.h"
+#include "TxtParsing.h"
+#include "TxtStreamParser.h"
 
+#include <algorithm>
 #include <benchmark/benchmark.h>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
 /// A note about the benchmarks here:
 /// Right now we do not intend to execute thses in any automated enivronment
 /// Consider them as a local developemnt tool if you want to fine tune the performance of specifc
 /// functions.
+
+// Note: The path below will only work if you call the benchmarks from the source folder,
+// i.e. from `jpsvis`  call: `./<path-to-build>/bin/benchmarks`
+// Most likely you will want to replace this path with a path to a much larger file anyways that
+// is not part of the repository, i.e. any trajectory upwards of 500 Mb.
+static const std::filesystem::path trajectoryPath =
+    std::filesystem::current_path() / "samples/02_stairs/stairs_trajectories.txt";
+
 static void BM_ParseTxtFormat(benchmark::State & state)
 {
-    // Note: The path below will only work if you call the benchmarks from the source folder,
-    // i.e. from `jpsvis`  call: `./<path-to-build>/bin/benchmarks`
-    // Most likely you will want to replace this path with a path to a much larger file anyways that
-    // is not part of the repository, i.e. any trajectory upwards of 500 Mb.
-    const auto path = QString::fromStdString(
-        std::filesystem::current_path() / "samples/02_stairs/stairs_trajectories.txt");
+    const auto path = QString::fromStdString(trajectoryPath.string());
+    size_t memoryUsage{0};
     for(auto _ : state) {
         TrajectoryData data;
         Parsing::ParseTxtFormat(path, &data);
+        memoryUsage = data.memoryUsage();
     }
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(trajectoryPath));
+    // Memory needed to hold the parsed frames
+    state.counters["MemoryUsage"] = static_cast<double>(memoryUsage);
 }
 BENCHMARK(BM_ParseTxtFormat);
+
+// Shows how the parsing throughput scales with the number of threads used. Use a large input file
+// here, the sample file is smaller than a single chunk and will always be parsed on one thread.
+static void BM_ParseTxtFormatThreads(benchmark::State & state)
+{
+    const auto path       = QString::fromStdString(trajectoryPath.string());
+    const auto numThreads = static_cast<unsigned int>(state.range(0));
+    for(auto _ : state) {
+        TrajectoryData data;
+        Parsing::ParseTxtFormat(path, &data, numThreads);
+    }
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(trajectoryPath));
+}
+BENCHMARK(BM_ParseTxtFormatThreads)->RangeMultiplier(2)->Range(1, 32)->UseRealTime();
+
+static void BM_ParseTxtFormatTextStream(benchmark::State & state)
+{
+    const auto path = QString::fromStdString(trajectoryPath.string());
+    for(auto _ : state) {
+        TrajectoryData data;
+        Parsing::ParseTxtFormatTextStream(path, &data);
+    }
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(trajectoryPath));
+}
+BENCHMARK(BM_ParseTxtFormatTextStream);
+
+/// @return contents of the trajectory file
+static std::string readTrajectory()
+{
+    std::ifstream file(trajectoryPath, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/// Parses every data line of the trajectory file with 'parseRecord'
+template <typename Parser>
+static void parseDataLines(benchmark::State & state, Parser parseRecord)
+{
+    const auto contents = readTrajectory();
+    const auto header   = Parsing::parseTxtHeader(contents);
+    const auto data     = std::string_view(contents).substr(header.dataOffset);
+    size_t lineCount{0};
+    for(auto _ : state) {
+        Parsing::TxtRecord record{};
+        lineCount = 0;
+        Parsing::forEachLine(data, [&parseRecord, &record, &lineCount](std::string_view line) {
+            benchmark::DoNotOptimize(parseRecord(line, record));
+            ++lineCount;
+        });
+        benchmark::DoNotOptimize(record);
+    }
+    state.SetItemsProcessed(state.iterations() * lineCount);
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+// Compares the parsers of single data lines: detecting the layout from the number of fields of
+// each line, the parser specialized on the layout declared in the header and the parser of
+// arbitrary layouts used for files with additional columns.
+static void BM_ParseTxtRecordDetected(benchmark::State & state)
+{
+    parseDataLines(state, [](std::string_view line, Parsing::TxtRecord & record) {
+        return Parsing::parseTxtRecord(line, record);
+    });
+}
+BENCHMARK(BM_ParseTxtRecordDetected);
+
+static void BM_ParseTxtRecordSpecialized(benchmark::State & state)
+{
+    parseDataLines(state, [](std::string_view line, Parsing::TxtRecord & record) {
+        return Parsing::parseTxtRecord<Parsing::TxtLayout::Kind::ELLIPSES>(line, record);
+    });
+}
+BENCHMARK(BM_ParseTxtRecordSpecialized);
+
+static void BM_ParseTxtRecordGeneric(benchmark::State & state)
+{
+    const auto layout = Parsing::parseTxtLayout("#ID FR X Y Z A B ANGLE COLOR");
+    parseDataLines(state, [&layout](std::string_view line, Parsing::TxtRecord & record) {
+        return Parsing::parseTxtRecord(line, layout, record);
+    });
+}
+BENCHMARK(BM_ParseTxtRecordGeneric);
+
+// Feeds the data section with its lines shuffled in a single piece, i.e. with frame ids in no
+// particular order. The records are still bucketed into complete frames by the counting sort.
+static void BM_TxtStreamParserUnordered(benchmark::State & state)
+{
+    const auto contents = readTrajectory();
+    const auto header   = Parsing::parseTxtHeader(contents);
+    std::vector<std::string_view> lines{};
+    Parsing::forEachLine(
+        std::string_view(contents).substr(header.dataOffset),
+        [&lines](std::string_view line) { lines.push_back(line); });
+    std::shuffle(lines.begin(), lines.end(), std::mt19937{42});
+    std::string data{};
+    for(const auto line : lines) {
+        data.append(line).push_back('\n');
+    }
+    for(auto _ : state) {
+        TrajectoryData trajectories;
+        Parsing::TxtStreamParser parser(&trajectories, 1, header.lineCount, header.layout);
+        parser.feed(data);
+        parser.finish();
+        benchmark::DoNotOptimize(trajectories.getFrameCount());
+    }
+    state.SetItemsProcessed(state.iterations() * lines.size());
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_TxtStreamParserUnordered);
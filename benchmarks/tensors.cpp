@@ -0,0 +1,104 @@
+#include "GlyphTensors.h"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Reports the glyph tensors computed per second as 'items_per_second'.
+
+namespace
+{
+struct Agents {
+    std::vector<float> radiusA;
+    std::vector<float> radiusB;
+    std::vector<float> angle;
+    std::vector<float> tensors;
+
+    explicit Agents(size_t count) :
+        radiusA(count), radiusB(count), angle(count), tensors(9 * count)
+    {
+        for(size_t i = 0; i < count; ++i) {
+            radiusA[i] = 20.f + static_cast<float>(i % 7);
+            radiusB[i] = 25.f + static_cast<float>(i % 5);
+            angle[i]   = static_cast<float>(i % 3600) * 0.1f - 180.f;
+        }
+    }
+};
+} // namespace
+
+static void BM_GlyphTensors2D(benchmark::State & state)
+{
+    const auto count = static_cast<size_t>(state.range(0));
+    Agents agents(count);
+    for(auto _ : state) {
+        computeGlyphTensors2D(
+            agents.radiusA.data(),
+            agents.radiusB.data(),
+            agents.angle.data(),
+            count,
+            1.f / 30.f,
+            0.25f,
+            agents.tensors.data());
+        benchmark::DoNotOptimize(agents.tensors.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_GlyphTensors2D)->Arg(10'000)->Arg(100'000)->Arg(1'000'000);
+
+static void BM_GlyphTensors3D(benchmark::State & state)
+{
+    const auto count = static_cast<size_t>(state.range(0));
+    Agents agents(count);
+    for(auto _ : state) {
+        computeGlyphTensors3D(agents.angle.data(), count, 170.f / 160.f, agents.tensors.data());
+        benchmark::DoNotOptimize(agents.tensors.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_GlyphTensors3D)->Arg(10'000)->Arg(100'000)->Arg(1'000'000);
+
+// Per agent computation in double precision with three rotation matrices as done before the
+// batched kernels, for comparison.
+static void BM_GlyphTensors2DPerAgent(benchmark::State & state)
+{
+    const auto count = static_cast<size_t>(state.range(0));
+    Agents agents(count);
+    const auto multiply = [](const double a[3][3], const double b[3][3], double c[3][3]) {
+        double result[3][3]{};
+        for(int i = 0; i < 3; ++i) {
+            for(int j = 0; j < 3; ++j) {
+                for(int k = 0; k < 3; ++k) {
+                    result[i][j] += a[i][k] * b[k][j];
+                }
+            }
+        }
+        std::copy(&result[0][0], &result[0][0] + 9, &c[0][0]);
+    };
+    for(auto _ : state) {
+        for(size_t i = 0; i < count; ++i) {
+            const double rot[3] = {0, 0, agents.angle[i] * M_PI / 180.};
+            double sc[3][3]     = {
+                {agents.radiusA[i] / 30., 0, 0}, {0, agents.radiusB[i] / 30., 0}, {0, 0, 0.25}};
+            double roX[3][3] = {
+                {1, 0, 0}, {0, cos(rot[0]), -sin(rot[0])}, {0, sin(rot[0]), cos(rot[0])}};
+            double roY[3][3] = {
+                {cos(rot[1]), 0, sin(rot[1])}, {0, 1, 0}, {-sin(rot[1]), 0, cos(rot[1])}};
+            double roZ[3][3] = {
+                {cos(rot[2]), sin(rot[2]), 0.0}, {-sin(rot[2]), cos(rot[2]), 0.0}, {0, 0, 1}};
+            double ro[3][3];
+            multiply(roX, roY, ro);
+            multiply(ro, roZ, ro);
+            double rs[3][3];
+            multiply(sc, ro, rs);
+            std::copy(&rs[0][0], &rs[0][0] + 9, agents.tensors.begin() + 9 * i);
+        }
+        benchmark::DoNotOptimize(agents.tensors.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_GlyphTensors2DPerAgent)->Arg(10'000)->Arg(100'000)->Arg(1'000'000);
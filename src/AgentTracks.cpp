@@ -0,0 +1,76 @@
+#include "AgentTracks.h"
+
+void AgentTracks::append(const Frame & frame)
+{
+    const int frameIndex = _frameCount++;
+    const auto columns   = frame.Columns();
+    for(int index = 0; index < frame.Size(); ++index) {
+        const int32_t id          = columns.id[index];
+        const auto [entry, isNew] =
+            _denseIndex.try_emplace(id, static_cast<uint32_t>(_tracks.size()));
+        if(isNew) {
+            _tracks.push_back({id, frameIndex, frameIndex});
+            _elements.emplace_back();
+        }
+        auto & track    = _tracks[entry->second];
+        auto & elements = _elements[entry->second];
+        // frames in between the agent was missing in, e.g. when it left and entered again
+        elements.resize(frameIndex - track.firstFrame, -1);
+        elements.push_back(index);
+        track.lastFrame = frameIndex;
+    }
+}
+
+void AgentTracks::clear()
+{
+    _denseIndex.clear();
+    _tracks.clear();
+    _elements.clear();
+    _frameCount = 0;
+}
+
+size_t AgentTracks::agentCount() const
+{
+    return _tracks.size();
+}
+
+int AgentTracks::frameCount() const
+{
+    return _frameCount;
+}
+
+std::optional<uint32_t> AgentTracks::denseIndex(int id) const
+{
+    const auto entry = _denseIndex.find(id);
+    if(entry == _denseIndex.end()) {
+        return std::nullopt;
+    }
+    return entry->second;
+}
+
+const AgentTracks::Track & AgentTracks::track(uint32_t agent) const
+{
+    return _tracks[agent];
+}
+
+int AgentTracks::elementIndex(uint32_t agent, int frame) const
+{
+    const auto & track = _tracks[agent];
+    if(frame < track.firstFrame || frame > track.lastFrame) {
+        return -1;
+    }
+    return _elements[agent][frame - track.firstFrame];
+}
+
+size_t AgentTracks::memoryUsage() const
+{
+    // approximation of the node based hash map: key, value and the next pointer per entry
+    size_t bytes = _denseIndex.bucket_count() * sizeof(void *) +
+                   _denseIndex.size() * (sizeof(int32_t) + sizeof(uint32_t) + sizeof(void *));
+    bytes += _tracks.capacity() * sizeof(Track);
+    bytes += _elements.capacity() * sizeof(std::vector<int32_t>);
+    for(const auto & elements : _elements) {
+        bytes += elements.capacity() * sizeof(int32_t);
+    }
+    return bytes;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Frame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+/// Index of the elements of every agent over time, built while the frames are appended.
+/// The sparse agent ids of the trajectory file are remapped to dense indices in order of their
+/// first appearance. For every agent the frames it is present in, from its first to its last
+/// frame, map to the position of its element in that frame. Agents only present for a part of
+/// the run, e.g. created by a source or removed at an exit, only use memory for their own life
+/// span. Looking up an agent in a frame is O(1) instead of a scan of the frame.
+class AgentTracks
+{
+public:
+    /// Life span of an agent
+    struct Track {
+        /// Id of the agent in the trajectory file
+        int id;
+        /// Index of the first frame the agent is present in
+        int firstFrame;
+        /// Index of the last frame the agent is present in
+        int lastFrame;
+    };
+
+private:
+    std::unordered_map<int32_t, uint32_t> _denseIndex{};
+    std::vector<Track> _tracks{};
+    /// Position of the element of each agent in the frames from its first to its last frame, -1
+    /// for frames the agent is missing in
+    std::vector<std::vector<int32_t>> _elements{};
+    int _frameCount{0};
+
+public:
+    /// Adds the elements of the next frame
+    /// @param frame appended after all frames added so far
+    void append(const Frame & frame);
+
+    /// Removes all agents and frames
+    void clear();
+
+    /// @return number of agents seen so far
+    size_t agentCount() const;
+
+    /// @return number of frames appended so far
+    int frameCount() const;
+
+    /// @param id of the agent in the trajectory file
+    /// @return dense index of the agent, nothing if it is not part of any frame
+    std::optional<uint32_t> denseIndex(int id) const;
+
+    /// @param agent dense index, needs to be less than agentCount()
+    /// @return life span of the agent
+    const Track & track(uint32_t agent) const;
+
+    /// @param agent dense index, needs to be less than agentCount()
+    /// @param frame index of the frame
+    /// @return position of the element of 'agent' in 'frame', -1 if the agent is not present
+    int elementIndex(uint32_t agent, int frame) const;
+
+    /// @return bytes used by the index
+    size_t memoryUsage() const;
+};
@@ -1,15 +1,28 @@
 #include "CLI.h"
 
 #include <iostream>
+#include <string_view>
 CLI parseCommandLine(
     QCommandLineParser & parser,
-    std::optional<std::filesystem::path> & path,
+    CommandLineArguments & arguments,
     QString * errorMessage)
 {
     parser.setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
     parser.addPositionalArgument("Trajectory", "trajfile");
     const QCommandLineOption helpOption    = parser.addHelpOption();
     const QCommandLineOption versionOption = parser.addVersionOption();
+    const QCommandLineOption renderOption(
+        "render",
+        "Render the trajectory without opening a window. Writes a video with ffmpeg, or a PNG "
+        "sequence if <file> ends in .png.",
+        "file");
+    const QCommandLineOption fromOption("from", "First frame to render.", "frame", "0");
+    const QCommandLineOption toOption("to", "Last frame to render, default is the last.", "frame");
+    const QCommandLineOption cameraOption(
+        "camera", "Camera: top, top:<degrees> or side:<degrees>.", "view", "top");
+    const QCommandLineOption sizeOption(
+        "size", "Size of the rendered frames in pixels.", "WxH", "1920x1080");
+    parser.addOptions({renderOption, fromOption, toOption, cameraOption, sizeOption});
     if(!parser.parse(QCoreApplication::arguments())) {
         *errorMessage = parser.errorText() + ". Try: 'jpsvis --help'";
         return CLI::CommandLineError;
@@ -26,23 +39,58 @@ CLI parseCommandLine(
         return CLI::CommandLineError;
     }
     if(!positionalArguments.isEmpty()) {
-        path = positionalArguments[0].toStdString();
+        arguments.path = positionalArguments[0].toStdString();
     }
 
+    if(!parser.isSet(renderOption)) {
+        return CLI::CommandLineOk;
+    }
+    if(!arguments.path) {
+        *errorMessage = "No trajectory file to render specified.  Try: 'jpsvis --help'";
+        return CLI::CommandLineError;
+    }
+    RenderOptions render;
+    render.output = parser.value(renderOption).toStdString();
+    render.camera = parser.value(cameraOption).toStdString();
+    bool ok{false};
+    render.from = parser.value(fromOption).toInt(&ok);
+    if(!ok || render.from < 0) {
+        *errorMessage = "Invalid first frame '" + parser.value(fromOption) + "'";
+        return CLI::CommandLineError;
+    }
+    if(parser.isSet(toOption)) {
+        render.to = parser.value(toOption).toInt(&ok);
+        if(!ok || render.to < render.from) {
+            *errorMessage = "Invalid last frame '" + parser.value(toOption) + "'";
+            return CLI::CommandLineError;
+        }
+    }
+    const QStringList size = parser.value(sizeOption).split('x');
+    bool heightOk{false};
+    if(size.size() == 2) {
+        render.width  = size[0].toInt(&ok);
+        render.height = size[1].toInt(&heightOk);
+    }
+    if(size.size() != 2 || !ok || !heightOk || render.width <= 0 || render.height <= 0) {
+        *errorMessage = "Invalid size '" + parser.value(sizeOption) + "', expected WxH";
+        return CLI::CommandLineError;
+    }
+    arguments.render = render;
+
     return CLI::CommandLineOk;
 }
 
-std::optional<std::filesystem::path> handleParserArguments()
+CommandLineArguments handleParserArguments()
 {
     QString errorMessage;
     QCommandLineParser parser;
-    std::optional<std::filesystem::path> path = {};
-    switch(parseCommandLine(parser, path, &errorMessage)) {
+    CommandLineArguments arguments;
+    switch(parseCommandLine(parser, arguments, &errorMessage)) {
         case CLI::CommandLineOk:
             break;
         case CLI::CommandLineError:
             Log::Error(errorMessage.toStdString().c_str());
-            std::exit(0);
+            std::exit(1);
         case CLI::CommandLineVersionRequested:
             Log::Info(
                 "%s: %s",
@@ -58,5 +106,18 @@ std::optional<std::filesystem::path> handleParserArguments()
             parser.showHelp();
             Q_UNREACHABLE();
     }
-    return path;
+    return arguments;
+}
+
+bool isRenderRequested(int argc, char * argv[])
+{
+    for(int i = 1; i < argc; ++i) {
+        const std::string_view argument{argv[i]};
+        // long options may be given with one or two dashes and with an attached value
+        const auto name = argument.substr(0, argument.find('='));
+        if(name == "--render" || name == "-render") {
+            return true;
+        }
+    }
+    return false;
 }
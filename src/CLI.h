@@ -1,6 +1,7 @@
 #pragma once
 #include "BuildInfo.h"
 #include "Log.h"
+#include "OffscreenRenderer.h"
 
 #include <QCommandLineParser>
 #include <QStringList>
@@ -14,9 +15,21 @@ enum class CLI {
     CommandLineHelpRequested
 };
 
+struct CommandLineArguments {
+    /// File to load on startup
+    std::optional<std::filesystem::path> path{};
+    /// Set if the file is rendered to a video without opening a window, see renderOffscreen()
+    std::optional<RenderOptions> render{};
+};
+
 CLI parseCommandLine(
     QCommandLineParser & parser,
-    std::optional<std::filesystem::path> & path,
+    CommandLineArguments & arguments,
     QString * errorMessage);
 
-std::optional<std::filesystem::path> handleParserArguments();
+CommandLineArguments handleParserArguments();
+
+/// Checks for the --render option before the application is created, no GUI application is
+/// created when rendering offscreen as it would require a display.
+/// @return true if --render is among the arguments
+bool isRenderRequested(int argc, char * argv[]);
@@ -23,39 +23,43 @@
  */
 #pragma once
 
+#include "FrameBlock.h"
 #include "FrameElement.h"
 
-#include <vector>
-#include <vtkPolyData.h>
-#include <vtkSmartPointer.h>
+#include <cstddef>
+#include <memory>
 
 /// Represents a single frame of the simulation
-/// TODO(kkratz): Split into FrameData / Frame2DModel / Frame3DModel
+/// A Frame is a lightweight view of the elements of one frame stored in a FrameBlock. Copying a
+/// Frame does not copy any elements, the FrameBlock is kept alive as long as a view to it exists.
+/// The VTK representation of a frame is built by Frame2DModel / Frame3DModel.
 class Frame
 {
-    std::vector<FrameElement> _framePoints;
+    std::shared_ptr<const FrameBlock> _block{};
+    size_t _begin{0};
+    size_t _size{0};
 
 public:
-    /// Constructor
+    /// Constructs an empty frame
     Frame() = default;
 
-    /// Destructor
-    ~Frame() = default;
-
-    /// Insert an Element to the Frame.
-    /// @param element to add
-    void InsertElement(FrameElement && element);
+    /// Constructor
+    /// @param block holding the elements
+    /// @param index of the frame in 'block'
+    Frame(std::shared_ptr<const FrameBlock> block, size_t index);
 
     /// @return the number of element in this frame
     int Size() const;
 
-    /// @return the 2D polydata set
-    vtkSmartPointer<vtkPolyData> GetPolyData2D();
+    /// Access a single element of this frame
+    /// @param index of the element, needs to be less than Size()
+    /// @return copy of the element
+    FrameElement ElementAt(int index) const;
 
-    /// @return the 3D polydata set
-    vtkSmartPointer<vtkPolyData> GetPolyData3D();
+    /// Access the elements of this frame column wise
+    /// @return columns pointing to the first element of this frame, Size() entries each
+    FrameBlock::Columns Columns() const;
 
-    /// Access Elements in this Frame
-    /// @preturn vector of FrameElements
-    const std::vector<FrameElement> & GetFrameElements() const;
+    /// @return the block holding the elements of this frame, may be null for an empty frame
+    const std::shared_ptr<const FrameBlock> & Block() const;
 };
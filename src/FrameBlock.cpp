@@ -0,0 +1,186 @@
+#include "FrameBlock.h"
+
+#include "general/Macros.h"
+
+#include <algorithm>
+#include <cassert>
+
+FrameBlock::Columns FrameBlock::Columns::advancedBy(size_t count) const
+{
+    return {
+        x + count,
+        y + count,
+        z + count,
+        radiusA + count,
+        radiusB + count,
+        angle + count,
+        color + count,
+        id + count};
+}
+
+void FrameBlock::FrameStats::add(float x, float y, float color)
+{
+    if(agents == 0) {
+        minX = maxX = x;
+        minY = maxY = y;
+    } else {
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+    }
+    ++agents;
+    if(color != -1) {
+        ++coloredAgents;
+        colorSum += color;
+    }
+}
+
+FrameBlock::Row FrameBlock::Row::from(const FrameElement & element)
+{
+    return {
+        static_cast<float>(element.pos[0]),
+        static_cast<float>(element.pos[1]),
+        static_cast<float>(element.pos[2]),
+        static_cast<float>(element.radius[0]),
+        static_cast<float>(element.radius[1]),
+        static_cast<float>(element.orientation[2]),
+        static_cast<float>(element.color),
+        element.id};
+}
+
+FrameBlock::FrameBlock(
+    std::shared_ptr<const void> external,
+    const Columns & columns,
+    std::vector<uint64_t> && offsets) :
+    _offsets(std::move(offsets)), _columns(columns), _external(std::move(external))
+{
+    assert(!_offsets.empty() && _offsets.front() == 0);
+    _stats.resize(frameCount());
+    for(size_t frame = 0; frame < frameCount(); ++frame) {
+        for(auto index = frameBegin(frame); index < frameEnd(frame); ++index) {
+            _stats[frame].add(_columns.x[index], _columns.y[index], _columns.color[index]);
+        }
+    }
+}
+
+FrameBlock::FrameBlock(
+    std::shared_ptr<const void> external,
+    const Columns & columns,
+    std::vector<uint64_t> && offsets,
+    std::vector<FrameStats> && stats) :
+    _offsets(std::move(offsets)),
+    _stats(std::move(stats)),
+    _columns(columns),
+    _external(std::move(external))
+{
+    assert(!_offsets.empty() && _offsets.front() == 0);
+    assert(_stats.size() == frameCount());
+}
+
+void FrameBlock::reserve(size_t frameCount, size_t elementCount)
+{
+    _offsets.reserve(frameCount + 1);
+    _stats.reserve(frameCount);
+    for(auto * column : {&_x, &_y, &_z, &_radiusA, &_radiusB, &_angle, &_color}) {
+        column->reserve(elementCount);
+    }
+    _id.reserve(elementCount);
+    updateColumns();
+}
+
+void FrameBlock::appendFrame(const std::vector<FrameElement> & elements)
+{
+    assert(!_external);
+    auto & stats = _stats.emplace_back();
+    for(const auto & element : elements) {
+        appendRow(Row::from(element), stats);
+    }
+    _offsets.push_back(_offsets.back() + elements.size());
+    updateColumns();
+}
+
+void FrameBlock::appendFrame(const Row * rows, size_t count)
+{
+    assert(!_external);
+    auto & stats = _stats.emplace_back();
+    for(size_t index = 0; index < count; ++index) {
+        appendRow(rows[index], stats);
+    }
+    _offsets.push_back(_offsets.back() + count);
+    updateColumns();
+}
+
+size_t FrameBlock::frameCount() const
+{
+    return _offsets.size() - 1;
+}
+
+size_t FrameBlock::elementCount() const
+{
+    return _offsets.back();
+}
+
+size_t FrameBlock::frameBegin(size_t frame) const
+{
+    return _offsets[frame];
+}
+
+size_t FrameBlock::frameEnd(size_t frame) const
+{
+    return _offsets[frame + 1];
+}
+
+const FrameBlock::FrameStats & FrameBlock::frameStats(size_t frame) const
+{
+    return _stats[frame];
+}
+
+const FrameBlock::Columns & FrameBlock::columns() const
+{
+    return _columns;
+}
+
+FrameElement FrameBlock::element(size_t index) const
+{
+    return FrameElement{
+        {_columns.x[index], _columns.y[index], _columns.z[index]},
+        {_columns.radiusA[index], _columns.radiusB[index], 0.3 * FAKTOR},
+        {0, 0, _columns.angle[index]},
+        _columns.color[index],
+        _columns.id[index]};
+}
+
+size_t FrameBlock::memoryUsage() const
+{
+    constexpr size_t bytesPerElement = 7 * sizeof(float) + sizeof(int32_t);
+    const size_t elements            = _external ? elementCount() : _x.capacity();
+    return elements * bytesPerElement + _offsets.capacity() * sizeof(uint64_t) +
+           _stats.capacity() * sizeof(FrameStats);
+}
+
+void FrameBlock::appendRow(const Row & row, FrameStats & stats)
+{
+    _x.push_back(row.x);
+    _y.push_back(row.y);
+    _z.push_back(row.z);
+    _radiusA.push_back(row.radiusA);
+    _radiusB.push_back(row.radiusB);
+    _angle.push_back(row.angle);
+    _color.push_back(row.color);
+    _id.push_back(row.id);
+    stats.add(row.x, row.y, row.color);
+}
+
+void FrameBlock::updateColumns()
+{
+    _columns = {
+        _x.data(),
+        _y.data(),
+        _z.data(),
+        _radiusA.data(),
+        _radiusB.data(),
+        _angle.data(),
+        _color.data(),
+        _id.data()};
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "FrameElement.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// Column oriented (structure of arrays) storage of the elements of consecutive frames.
+/// Every column holds one float32 entry per element, the elements of frame i are the range
+/// [frameBegin(i), frameEnd(i)). Lengths are stored in cm, the radius in z direction and the
+/// rotation around x and y are constant and not stored. This needs 32 bytes per element compared
+/// to 88 bytes per FrameElement.
+/// The columns are either owned by the block or point into external memory, e.g. a memory mapped
+/// trajectory cache, that is kept alive by the block. A block is not modified once it has been
+/// handed to TrajectoryData.
+/// Statistics of every frame are gathered while its elements are converted to columns, so
+/// timelines need not read the elements again.
+class FrameBlock
+{
+public:
+    /// Pointers to the columns of a block, each pointing to the first element of interest
+    struct Columns {
+        const float * x{nullptr};
+        const float * y{nullptr};
+        const float * z{nullptr};
+        const float * radiusA{nullptr};
+        const float * radiusB{nullptr};
+        const float * angle{nullptr};
+        const float * color{nullptr};
+        const int32_t * id{nullptr};
+
+        /// @return Columns pointing 'count' elements further
+        Columns advancedBy(size_t count) const;
+    };
+
+    /// Statistics of the elements of one frame
+    struct FrameStats {
+        /// Number of elements
+        uint32_t agents{0};
+        /// Number of elements with a color, i.e. other than -1
+        uint32_t coloredAgents{0};
+        /// Sum of the colors of the elements with a color. jpscore colors the agents by their
+        /// speed relative to their desired speed, 0 standing and 255 walking at desired speed.
+        double colorSum{0};
+        /// Bounding box of the elements in the x-y plane, all 0 without elements
+        float minX{0};
+        float minY{0};
+        float maxX{0};
+        float maxY{0};
+
+        /// Adds an element
+        void add(float x, float y, float color);
+    };
+
+    /// A single element in the precision of the columns, the row oriented counterpart of Columns
+    struct Row {
+        float x;
+        float y;
+        float z;
+        float radiusA;
+        float radiusB;
+        float angle;
+        float color;
+        int32_t id;
+
+        /// @return 'element' converted to the precision of the columns
+        static Row from(const FrameElement & element);
+    };
+
+private:
+    std::vector<uint64_t> _offsets{0};
+    std::vector<FrameStats> _stats{};
+    Columns _columns{};
+    std::vector<float> _x{};
+    std::vector<float> _y{};
+    std::vector<float> _z{};
+    std::vector<float> _radiusA{};
+    std::vector<float> _radiusB{};
+    std::vector<float> _angle{};
+    std::vector<float> _color{};
+    std::vector<int32_t> _id{};
+    std::shared_ptr<const void> _external{};
+
+public:
+    /// Creates an empty block that owns its columns, use appendFrame() to fill it.
+    FrameBlock() = default;
+
+    /// Creates a block on top of external columns, the statistics are computed from the columns
+    /// @param external memory holding the columns, kept alive as long as the block exists
+    /// @param columns pointing to the first element of the block
+    /// @param offsets frame offsets, frameCount + 1 entries starting with 0
+    FrameBlock(
+        std::shared_ptr<const void> external,
+        const Columns & columns,
+        std::vector<uint64_t> && offsets);
+
+    /// Creates a block on top of external columns with known statistics, the columns are not read
+    /// @param external memory holding the columns, kept alive as long as the block exists
+    /// @param columns pointing to the first element of the block
+    /// @param offsets frame offsets, frameCount + 1 entries starting with 0
+    /// @param stats statistics of each frame, frameCount entries
+    FrameBlock(
+        std::shared_ptr<const void> external,
+        const Columns & columns,
+        std::vector<uint64_t> && offsets,
+        std::vector<FrameStats> && stats);
+
+    FrameBlock(const FrameBlock &) = delete;
+    FrameBlock & operator=(const FrameBlock &) = delete;
+    ~FrameBlock()                              = default;
+
+    /// Reserve memory for the elements to be appended
+    /// @param frameCount total number of frames
+    /// @param elementCount total number of elements
+    void reserve(size_t frameCount, size_t elementCount);
+
+    /// Appends a frame consisting of 'elements'. Only valid for blocks owning their columns.
+    /// @param elements of the new frame
+    void appendFrame(const std::vector<FrameElement> & elements);
+
+    /// Appends a frame consisting of 'count' rows starting at 'rows'. Only valid for blocks owning
+    /// their columns.
+    /// @param rows elements of the new frame
+    /// @param count number of elements
+    void appendFrame(const Row * rows, size_t count);
+
+    /// @return number of frames in this block
+    size_t frameCount() const;
+
+    /// @return number of elements of all frames in this block
+    size_t elementCount() const;
+
+    /// @param frame index in this block
+    /// @return index of the first element of 'frame'
+    size_t frameBegin(size_t frame) const;
+
+    /// @param frame index in this block
+    /// @return index past the last element of 'frame'
+    size_t frameEnd(size_t frame) const;
+
+    /// @param frame index in this block
+    /// @return statistics of the elements of 'frame'
+    const FrameStats & frameStats(size_t frame) const;
+
+    /// @return the columns of this block, pointing to element 0
+    const Columns & columns() const;
+
+    /// @param index of the element in this block
+    /// @return the element at 'index' converted to a FrameElement
+    FrameElement element(size_t index) const;
+
+    /// @return bytes used by the columns, the frame offsets and the statistics
+    size_t memoryUsage() const;
+
+private:
+    void appendRow(const Row & row, FrameStats & stats);
+    void updateColumns();
+};
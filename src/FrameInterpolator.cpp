@@ -0,0 +1,97 @@
+#include "FrameInterpolator.h"
+
+#include <cmath>
+
+namespace
+{
+/// Agents with ids outside of [0, maxDenseId) are not interpolated, this bounds the lookup table
+constexpr int32_t maxDenseId = 1 << 20;
+/// Number of float columns of an interpolated frame
+constexpr size_t floatColumns = 7;
+} // namespace
+
+Frame FrameInterpolator::Interpolate(const Frame & from, const Frame & to, float fraction)
+{
+    const size_t count = from.Size();
+    const auto a       = from.Columns();
+    const auto b       = to.Columns();
+
+    for(int i = 0; i < to.Size(); ++i) {
+        const int32_t id = b.id[i];
+        if(id < 0 || id >= maxDenseId) {
+            continue;
+        }
+        if(static_cast<size_t>(id) >= _indexOfId.size()) {
+            _indexOfId.resize(id + 1, -1);
+        }
+        _indexOfId[id] = i;
+    }
+
+    auto buffer = freeBuffer();
+    buffer->values.resize(floatColumns * count);
+    buffer->ids.assign(a.id, a.id + count);
+
+    FrameBlock::Columns columns;
+    float * x       = buffer->values.data();
+    float * y       = x + count;
+    float * z       = y + count;
+    float * radiusA = z + count;
+    float * radiusB = radiusA + count;
+    float * angle   = radiusB + count;
+    float * color   = angle + count;
+    columns.x       = x;
+    columns.y       = y;
+    columns.z       = z;
+    columns.radiusA = radiusA;
+    columns.radiusB = radiusB;
+    columns.angle   = angle;
+    columns.color   = color;
+    columns.id      = buffer->ids.data();
+
+    for(size_t i = 0; i < count; ++i) {
+        const int32_t id = a.id[i];
+        const int32_t j  = (id >= 0 && static_cast<size_t>(id) < _indexOfId.size()) ?
+                               _indexOfId[id] :
+                               -1;
+        x[i]       = a.x[i];
+        y[i]       = a.y[i];
+        z[i]       = a.z[i];
+        radiusA[i] = a.radiusA[i];
+        radiusB[i] = a.radiusB[i];
+        angle[i]   = a.angle[i];
+        color[i]   = a.color[i];
+        if(j < 0) {
+            continue;
+        }
+        x[i] += fraction * (b.x[j] - a.x[i]);
+        y[i] += fraction * (b.y[j] - a.y[i]);
+        z[i] += fraction * (b.z[j] - a.z[i]);
+        // along the shorter arc, the difference is mapped to [-180, 180]
+        const float turn = b.angle[j] - a.angle[i];
+        angle[i] += fraction * (turn - 360.f * std::round(turn / 360.f));
+    }
+
+    // reset the lookup table for the next call
+    for(int i = 0; i < to.Size(); ++i) {
+        const int32_t id = b.id[i];
+        if(id >= 0 && id < maxDenseId) {
+            _indexOfId[id] = -1;
+        }
+    }
+
+    auto block = std::make_shared<FrameBlock>(
+        buffer, columns, std::vector<uint64_t>{0, static_cast<uint64_t>(count)});
+    return Frame(block, 0);
+}
+
+std::shared_ptr<FrameInterpolator::Buffer> FrameInterpolator::freeBuffer()
+{
+    for(const auto & buffer : _buffers) {
+        // only referenced by this interpolator
+        if(buffer.use_count() == 1) {
+            return buffer;
+        }
+    }
+    _buffers.push_back(std::make_shared<Buffer>());
+    return _buffers.back();
+}
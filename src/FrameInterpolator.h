@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Frame.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// Creates frames between two recorded frames for smooth replay.
+/// Agents are matched by id. Positions are interpolated linearly and orientations along the
+/// shorter arc, all other values are taken from the earlier frame. Agents that are only part of
+/// the earlier frame stay in place, agents that are only part of the later frame appear with it.
+/// The elements of an interpolated frame are stored in buffers that are reused once no Frame
+/// refers to them any more, so interpolating does not allocate memory in the steady state.
+class FrameInterpolator
+{
+    /// Columns of an interpolated frame
+    struct Buffer {
+        std::vector<float> values{};
+        std::vector<int32_t> ids{};
+    };
+
+    std::vector<std::shared_ptr<Buffer>> _buffers{};
+    /// Index of the agent in the later frame by agent id, -1 if it is not part of it
+    std::vector<int32_t> _indexOfId{};
+
+public:
+    FrameInterpolator()  = default;
+    ~FrameInterpolator() = default;
+
+    FrameInterpolator(const FrameInterpolator &) = delete;
+    FrameInterpolator & operator=(const FrameInterpolator &) = delete;
+
+    /// @param from earlier frame
+    /// @param to later frame
+    /// @param fraction of the way from 'from' to 'to', in [0, 1]
+    /// @return the agents of 'from' moved towards their state in 'to' by 'fraction'
+    Frame Interpolate(const Frame & from, const Frame & to, float fraction);
+
+private:
+    /// @return a buffer no frame refers to
+    std::shared_ptr<Buffer> freeBuffer();
+};
@@ -0,0 +1,257 @@
+#include "FrameModel.h"
+
+#include "GlyphTensors.h"
+#include "general/Macros.h"
+
+#include <cmath>
+#include <vtkPointData.h>
+
+namespace
+{
+/// @return pointer to the x coordinate of the first point of 'points'
+float * pointsWritePointer(vtkPoints * points, vtkIdType count)
+{
+    return static_cast<vtkFloatArray *>(points->GetData())->WritePointer(0, 3 * count);
+}
+} // namespace
+
+FrameModel::FrameModel(bool labels) :
+    _polyData(vtkSmartPointer<vtkPolyData>::New()), _labels(labels)
+{
+    createArrays(_buffers[_presented]);
+
+    // setting the colors
+    _polyData->SetPoints(_buffers[_presented].points);
+    _polyData->GetPointData()->AddArray(_buffers[_presented].colors);
+    _polyData->GetPointData()->SetActiveScalars("color");
+
+    // setting the scaling and rotation
+    _polyData->GetPointData()->SetTensors(_buffers[_presented].tensors);
+    _polyData->GetPointData()->SetActiveTensors("tensors");
+
+    // setting the labels
+    if(_labels) {
+        _polyData->GetPointData()->AddArray(_buffers[_presented].labels);
+    }
+}
+
+void FrameModel::Prepare(const Frame & frame, int buffer)
+{
+    auto & target = _buffers[buffer];
+    if(!target.points) {
+        createArrays(target);
+    }
+    if(frame.Block() == target.frame.Block() && frame.Columns().x == target.frame.Columns().x &&
+       frame.Size() == target.frame.Size()) {
+        return;
+    }
+    target.frame = frame;
+
+    const vtkIdType count = frame.Size();
+    if(count != target.points->GetNumberOfPoints()) {
+        resize(target, count);
+    }
+
+    const auto columns = frame.Columns();
+    float * colors     = target.colors->WritePointer(0, count);
+    for(vtkIdType i = 0; i < count; ++i) {
+        colors[i] = columns.color[i] == -1 ? NAN : columns.color[i] / 255.f;
+    }
+    write(frame, target);
+
+    target.points->Modified();
+    target.colors->Modified();
+    if(_instanced) {
+        target.scales->Modified();
+        target.orientations->Modified();
+    } else {
+        target.tensors->Modified();
+    }
+    if(target.labels) {
+        target.labels->Modified();
+    }
+}
+
+void FrameModel::Present(int buffer)
+{
+    // arrays with the name of an attached array replace it and keep its attribute role
+    const auto & source = _buffers[buffer];
+    auto * pointData    = _polyData->GetPointData();
+    _polyData->SetPoints(source.points);
+    pointData->AddArray(source.colors);
+    if(_instanced) {
+        pointData->AddArray(source.scales);
+        pointData->AddArray(source.orientations);
+    } else {
+        pointData->SetTensors(source.tensors);
+    }
+    if(source.labels) {
+        pointData->AddArray(source.labels);
+    }
+    _presented = buffer;
+    _polyData->Modified();
+}
+
+void FrameModel::SetInstanced(bool instanced)
+{
+    if(instanced == _instanced) {
+        return;
+    }
+    _instanced = instanced;
+
+    auto * pointData = _polyData->GetPointData();
+    if(_instanced) {
+        pointData->RemoveArray("tensors");
+    } else {
+        pointData->RemoveArray("scales");
+        pointData->RemoveArray("orientations");
+    }
+    for(auto & buffer : _buffers) {
+        if(buffer.points) {
+            resize(buffer, buffer.points->GetNumberOfPoints());
+            buffer.frame = Frame{};
+        }
+    }
+    Present(_presented);
+}
+
+size_t FrameModel::MemoryUsage(int buffer) const
+{
+    const auto & source = _buffers[buffer];
+    if(!source.points) {
+        return 0;
+    }
+    // in KiB
+    size_t size = source.points->GetData()->GetActualMemorySize() +
+                  source.colors->GetActualMemorySize() + source.tensors->GetActualMemorySize() +
+                  source.scales->GetActualMemorySize() +
+                  source.orientations->GetActualMemorySize();
+    if(source.labels) {
+        size += source.labels->GetActualMemorySize();
+    }
+    return size * 1024;
+}
+
+vtkPolyData * FrameModel::GetPolyData() const
+{
+    return _polyData;
+}
+
+void FrameModel::createArrays(Buffer & buffer) const
+{
+    buffer.points = vtkSmartPointer<vtkPoints>::New();
+    buffer.points->SetDataTypeToFloat();
+
+    buffer.colors = vtkSmartPointer<vtkFloatArray>::New();
+    buffer.colors->SetName("color");
+    buffer.colors->SetNumberOfComponents(1);
+
+    buffer.tensors = vtkSmartPointer<vtkFloatArray>::New();
+    buffer.tensors->SetName("tensors");
+    buffer.tensors->SetNumberOfComponents(9);
+
+    buffer.scales = vtkSmartPointer<vtkFloatArray>::New();
+    buffer.scales->SetName("scales");
+    buffer.scales->SetNumberOfComponents(3);
+
+    buffer.orientations = vtkSmartPointer<vtkFloatArray>::New();
+    buffer.orientations->SetName("orientations");
+    buffer.orientations->SetNumberOfComponents(3);
+
+    if(_labels) {
+        buffer.labels = vtkSmartPointer<vtkIntArray>::New();
+        buffer.labels->SetName("labels");
+        buffer.labels->SetNumberOfComponents(1);
+    }
+}
+
+void FrameModel::resize(Buffer & buffer, vtkIdType count) const
+{
+    buffer.points->SetNumberOfPoints(count);
+    buffer.colors->SetNumberOfTuples(count);
+    // the arrays of the pipeline not in use are released
+    buffer.tensors->SetNumberOfTuples(_instanced ? 0 : count);
+    buffer.scales->SetNumberOfTuples(_instanced ? count : 0);
+    buffer.orientations->SetNumberOfTuples(_instanced ? count : 0);
+    if(buffer.labels) {
+        buffer.labels->SetNumberOfTuples(count);
+    }
+}
+
+Frame2DModel::Frame2DModel() : FrameModel(true) {}
+
+void Frame2DModel::write(const Frame & frame, Buffer & buffer) const
+{
+    const vtkIdType count = frame.Size();
+    const auto columns    = frame.Columns();
+    float * points        = pointsWritePointer(buffer.points, count);
+    int * labels          = buffer.labels->WritePointer(0, count);
+    for(vtkIdType i = 0; i < count; ++i) {
+        points[3 * i]     = columns.x[i];
+        points[3 * i + 1] = columns.y[i];
+        points[3 * i + 2] = columns.z[i];
+        labels[i]         = columns.id[i] + 1;
+    }
+
+    // the disk glyph has a radius of 30, agents are drawn with their z radius / 120 in z
+    constexpr float radiusScale = 1.f / 30.f;
+    constexpr float zScale      = 0.3f * FAKTOR / 120.f;
+    if(_instanced) {
+        float * scales       = buffer.scales->WritePointer(0, 3 * count);
+        float * orientations = buffer.orientations->WritePointer(0, 3 * count);
+        for(vtkIdType i = 0; i < count; ++i) {
+            scales[3 * i]           = columns.radiusA[i] * radiusScale;
+            scales[3 * i + 1]       = columns.radiusB[i] * radiusScale;
+            scales[3 * i + 2]       = zScale;
+            orientations[3 * i]     = 0.f;
+            orientations[3 * i + 1] = 0.f;
+            orientations[3 * i + 2] = columns.angle[i];
+        }
+    } else {
+        computeGlyphTensors2D(
+            columns.radiusA,
+            columns.radiusB,
+            columns.angle,
+            count,
+            radiusScale,
+            zScale,
+            buffer.tensors->WritePointer(0, 9 * count));
+    }
+}
+
+Frame3DModel::Frame3DModel() : FrameModel(false) {}
+
+void Frame3DModel::write(const Frame & frame, Buffer & buffer) const
+{
+    // values for cylinder
+    constexpr double height    = 170;
+    constexpr double maxHeight = 160;
+
+    const vtkIdType count = frame.Size();
+    const auto columns    = frame.Columns();
+    float * points        = pointsWritePointer(buffer.points, count);
+    for(vtkIdType i = 0; i < count; ++i) {
+        points[3 * i]     = columns.x[i];
+        points[3 * i + 1] = columns.y[i];
+        // slightly above ground
+        points[3 * i + 2] = columns.z[i] + static_cast<float>(height / 2.0 - 30);
+    }
+
+    constexpr auto heightScale = static_cast<float>(height / maxHeight);
+    if(_instanced) {
+        // the cylinder source is aligned with the y axis, it is stood up by rotating around x
+        float * scales       = buffer.scales->WritePointer(0, 3 * count);
+        float * orientations = buffer.orientations->WritePointer(0, 3 * count);
+        for(vtkIdType i = 0; i < count; ++i) {
+            scales[3 * i]           = 1.f;
+            scales[3 * i + 1]       = heightScale;
+            scales[3 * i + 2]       = 1.f;
+            orientations[3 * i]     = 90.f;
+            orientations[3 * i + 1] = 0.f;
+            orientations[3 * i + 2] = columns.angle[i];
+        }
+    } else {
+        computeGlyphTensors3D(
+            columns.angle, count, heightScale, buffer.tensors->WritePointer(0, 9 * count));
+    }
+}
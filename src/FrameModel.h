@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Frame.h"
+
+#include <array>
+#include <vtkFloatArray.h>
+#include <vtkIntArray.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+/// Persistent VTK representation of the agents of the displayed frame.
+/// The polydata is created once and connected to the render pipeline once. The per agent arrays
+/// exist BUFFER_COUNT times: Prepare() writes a frame into the arrays of one buffer and Present()
+/// swaps the arrays of a buffer into the polydata. A buffer that is not presented can be prepared
+/// on another thread while the presented one is rendered, see FramePreparer. The buffers beyond
+/// WORKING_BUFFER_COUNT keep frames presented before, so seeking back to them needs no work. The
+/// arrays of a buffer are created when it is prepared the first time and are only resized if the
+/// number of agents changes, so no VTK objects are allocated per rendered frame.
+/// The glyphs are either computed on the CPU by vtkTensorGlyph from per agent tensors, or drawn
+/// instanced by vtkGlyph3DMapper from per agent scale and orientation arrays, see SetInstanced().
+/// Only the arrays needed by the selected pipeline are attached and written.
+class FrameModel
+{
+public:
+    /// Number of buffers needed for the replay: one presented, one prepared and waiting, one being
+    /// prepared
+    static constexpr int WORKING_BUFFER_COUNT = 3;
+
+    /// Number of buffers including the ones keeping frames for seeking
+    static constexpr int BUFFER_COUNT = WORKING_BUFFER_COUNT + 256;
+
+protected:
+    /// Per agent arrays of one frame, null until the buffer is prepared the first time
+    struct Buffer {
+        vtkSmartPointer<vtkPoints> points;
+        vtkSmartPointer<vtkFloatArray> colors;
+        vtkSmartPointer<vtkFloatArray> tensors;
+        /// Scale in x, y, z per agent for instanced rendering
+        vtkSmartPointer<vtkFloatArray> scales;
+        /// Rotation around x, y, z in degrees per agent for instanced rendering
+        vtkSmartPointer<vtkFloatArray> orientations;
+        /// Agent ids, only created by models with labels
+        vtkSmartPointer<vtkIntArray> labels;
+        /// Frame stored in the arrays, keeps its block alive to detect repeated updates
+        Frame frame{};
+    };
+
+    vtkSmartPointer<vtkPolyData> _polyData;
+    std::array<Buffer, BUFFER_COUNT> _buffers{};
+    int _presented{0};
+    bool _instanced{false};
+    bool _labels{false};
+
+    /// Constructor
+    /// @param labels create the "labels" array holding the agent ids
+    explicit FrameModel(bool labels);
+
+public:
+    virtual ~FrameModel() = default;
+
+    FrameModel(const FrameModel &) = delete;
+    FrameModel & operator=(const FrameModel &) = delete;
+
+    /// Writes the agents of 'frame' into the arrays of 'buffer'. Nothing is done if 'frame' is
+    /// already stored. May be called from any thread, as long as 'buffer' is not presented and
+    /// no other thread accesses it meanwhile.
+    /// @param frame to display
+    /// @param buffer index in [0, BUFFER_COUNT)
+    void Prepare(const Frame & frame, int buffer);
+
+    /// Swaps the arrays of 'buffer' into the polydata, they are rendered from now on
+    /// @param buffer index in [0, BUFFER_COUNT), prepared before
+    void Present(int buffer);
+
+    /// @param buffer index in [0, BUFFER_COUNT)
+    /// @return bytes used by the arrays of 'buffer'
+    size_t MemoryUsage(int buffer) const;
+
+    /// Selects the arrays written by Prepare(). All buffers are written again with the next call
+    /// to Prepare(), no buffer may be prepared meanwhile.
+    /// @param instanced write "scales" and "orientations" if true, "tensors" otherwise
+    void SetInstanced(bool instanced);
+
+    /// @return the polydata, valid for the whole lifetime of the model
+    vtkPolyData * GetPolyData() const;
+
+protected:
+    /// Creates the empty arrays of 'buffer'
+    void createArrays(Buffer & buffer) const;
+
+    /// Resizes the arrays of 'buffer' to hold 'count' agents
+    /// @param buffer to resize
+    /// @param count number of agents
+    void resize(Buffer & buffer, vtkIdType count) const;
+
+    /// Writes the points, the glyph tensors or scales and orientations and further per agent data
+    /// of 'frame' into the arrays of 'buffer'
+    /// @param frame to write
+    /// @param buffer to write to, the arrays have been resized to frame.Size()
+    virtual void write(const Frame & frame, Buffer & buffer) const = 0;
+};
+
+/// Agents as ellipses in the x-y plane, with labels holding the agent ids
+class Frame2DModel : public FrameModel
+{
+public:
+    Frame2DModel();
+    ~Frame2DModel() override = default;
+
+private:
+    void write(const Frame & frame, Buffer & buffer) const override;
+};
+
+/// Agents as upright cylinders
+class Frame3DModel : public FrameModel
+{
+public:
+    Frame3DModel();
+    ~Frame3DModel() override = default;
+
+private:
+    void write(const Frame & frame, Buffer & buffer) const override;
+};
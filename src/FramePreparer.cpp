@@ -0,0 +1,271 @@
+#include "FramePreparer.h"
+
+#include "TrajectoryData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+FramePreparer::FramePreparer(
+    TrajectoryData & trajectories,
+    Frame2DModel & model2D,
+    Frame3DModel & model3D,
+    size_t cacheBudget) :
+    _trajectories(trajectories), _model2D(model2D), _model3D(model3D), _cacheBudget(cacheBudget)
+{
+    for(auto & slot : _slots) {
+        slot.position = NAN;
+    }
+    // the models start with their first buffer attached
+    _slots[0].state = State::PRESENTED;
+    _worker         = std::thread(&FramePreparer::run, this);
+}
+
+FramePreparer::~FramePreparer()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _changed.notify_all();
+    _worker.join();
+}
+
+void FramePreparer::SetModels(bool write2D, bool write3D)
+{
+    std::unique_lock lock(_mutex);
+    if(write2D == _write2D && write3D == _write3D) {
+        return;
+    }
+    discard(lock);
+    _write2D = write2D;
+    _write3D = write3D;
+}
+
+void FramePreparer::Invalidate()
+{
+    std::unique_lock lock(_mutex);
+    discard(lock);
+}
+
+void FramePreparer::Present(double position, double tolerance)
+{
+    std::unique_lock lock(_mutex);
+    updateGeneration();
+    ++_useCount;
+    const int presented = findSlot(State::PRESENTED, position, tolerance);
+    if(presented >= 0) {
+        _slots[presented].lastUse = _useCount;
+        return;
+    }
+    int next = findSlot(State::READY, position, tolerance);
+    if(next < 0) {
+        next = findSlot(State::CACHED, position, tolerance);
+    }
+    if(next < 0) {
+        // not prepared in time and not cached, e.g. after seeking
+        _request = position;
+        _changed.notify_all();
+        _changed.wait(lock, [&]() {
+            next = findSlot(State::READY, position, 0);
+            return next >= 0;
+        });
+    }
+    const auto previous = std::find_if(_slots.begin(), _slots.end(), [](const Slot & slot) {
+        return slot.state == State::PRESENTED;
+    });
+    _slots[next].state   = State::PRESENTED;
+    _slots[next].lastUse = _useCount;
+    if(previous != _slots.end()) {
+        release(*previous);
+    }
+    // a model that is not written keeps stale arrays, it is not displayed
+    _model2D.Present(next);
+    _model3D.Present(next);
+    _changed.notify_all();
+}
+
+void FramePreparer::Request(double position)
+{
+    {
+        std::lock_guard lock(_mutex);
+        updateGeneration();
+        if(isAvailable(position)) {
+            return;
+        }
+        // replaces a request not picked up yet, only the latest position is prepared
+        _request = position;
+    }
+    _changed.notify_all();
+}
+
+void FramePreparer::run()
+{
+    std::unique_lock lock(_mutex);
+    while(true) {
+        _changed.wait(lock, [this]() { return _stop || _request; });
+        if(_stop) {
+            return;
+        }
+        const double position = *_request;
+        _request.reset();
+        if(isAvailable(position)) {
+            continue;
+        }
+
+        const int free                = acquire();
+        _slots[free].state            = State::WRITING;
+        const bool write2D            = _write2D;
+        const bool write3D            = _write3D;
+        const unsigned int generation = _generation;
+        lock.unlock();
+
+        const auto frame = frameAt(position);
+        if(write2D) {
+            _model2D.Prepare(frame, free);
+        }
+        if(write3D) {
+            _model3D.Prepare(frame, free);
+        }
+        const size_t bytes = _model2D.MemoryUsage(free) + _model3D.MemoryUsage(free);
+
+        lock.lock();
+        for(auto & slot : _slots) {
+            if(slot.state == State::READY) {
+                release(slot);
+            }
+        }
+        _slots[free].state      = State::READY;
+        _slots[free].position   = position;
+        _slots[free].generation = generation;
+        _slots[free].bytes      = bytes;
+        _slots[free].lastUse    = _useCount;
+        _changed.notify_all();
+    }
+}
+
+Frame FramePreparer::frameAt(double position)
+{
+    const int index      = static_cast<int>(std::floor(position));
+    const float fraction = static_cast<float>(position - index);
+    if(fraction <= 0) {
+        return _trajectories.frameAt(index);
+    }
+    // both frames are fetched at once, the frames may be cleared concurrently by a reload
+    const auto [frame, next] = _trajectories.framesAt(index);
+    if(!frame.Block() || !next.Block()) {
+        return frame;
+    }
+    return _interpolator.Interpolate(frame, next, fraction);
+}
+
+void FramePreparer::discard(std::unique_lock<std::mutex> & lock)
+{
+    _request.reset();
+    _changed.wait(lock, [this]() {
+        return std::none_of(_slots.begin(), _slots.end(), [](const Slot & slot) {
+            return slot.state == State::WRITING;
+        });
+    });
+    for(auto & slot : _slots) {
+        if(slot.state == State::READY || slot.state == State::CACHED) {
+            slot.state = State::FREE;
+        }
+        slot.position = NAN;
+    }
+}
+
+void FramePreparer::updateGeneration()
+{
+    const unsigned int generation = _trajectories.getGeneration();
+    if(generation == _generation) {
+        return;
+    }
+    _generation = generation;
+    for(auto & slot : _slots) {
+        if(slot.state == State::READY || slot.state == State::CACHED) {
+            slot.state    = State::FREE;
+            slot.position = NAN;
+        }
+    }
+}
+
+int FramePreparer::findSlot(State state, double position, double tolerance) const
+{
+    for(size_t i = 0; i < _slots.size(); ++i) {
+        const auto & slot = _slots[i];
+        if(slot.state == state && slot.generation == _generation &&
+           std::abs(slot.position - position) <= tolerance) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool FramePreparer::isAvailable(double position) const
+{
+    return findSlot(State::PRESENTED, position, 0) >= 0 ||
+           findSlot(State::READY, position, 0) >= 0 || findSlot(State::CACHED, position, 0) >= 0;
+}
+
+void FramePreparer::release(Slot & slot)
+{
+    // interpolated frames are hardly ever displayed again
+    if(slot.generation == _generation && slot.position == std::floor(slot.position)) {
+        slot.state = State::CACHED;
+    } else {
+        slot.state    = State::FREE;
+        slot.position = NAN;
+    }
+
+    size_t cached{0};
+    for(const auto & entry : _slots) {
+        if(entry.state == State::CACHED) {
+            cached += entry.bytes;
+        }
+    }
+    while(cached > _cacheBudget) {
+        cached -= evict(leastRecentlyUsed());
+    }
+}
+
+int FramePreparer::acquire()
+{
+    int unallocated{-1};
+    for(size_t i = 0; i < _slots.size(); ++i) {
+        if(_slots[i].state != State::FREE) {
+            continue;
+        }
+        if(_slots[i].bytes > 0) {
+            return static_cast<int>(i);
+        }
+        if(unallocated < 0) {
+            unallocated = static_cast<int>(i);
+        }
+    }
+    if(unallocated >= 0) {
+        return unallocated;
+    }
+    // there is always a cached slot then: at most one is presented, ready and written each
+    auto & evicted = leastRecentlyUsed();
+    evict(evicted);
+    return static_cast<int>(&evicted - _slots.data());
+}
+
+size_t FramePreparer::evict(Slot & slot)
+{
+    slot.state    = State::FREE;
+    slot.position = NAN;
+    return slot.bytes;
+}
+
+FramePreparer::Slot & FramePreparer::leastRecentlyUsed()
+{
+    Slot * oldest = nullptr;
+    for(auto & slot : _slots) {
+        if(slot.state == State::CACHED && (!oldest || slot.lastUse < oldest->lastUse)) {
+            oldest = &slot;
+        }
+    }
+    return *oldest;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "FrameInterpolator.h"
+#include "FrameModel.h"
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+class TrajectoryData;
+
+/// Prepares the VTK arrays of upcoming frames on a worker thread.
+/// The render thread requests the replay position it expects to present next with Request().
+/// The worker interpolates the frame at that position and writes it into a free buffer of the
+/// frame models while the current frame is rendered. Present() then only swaps the arrays of the
+/// prepared buffer into the polydata. If no prepared buffer is close enough to the position to
+/// present, e.g. after seeking, the render thread waits for the worker to prepare it.
+/// The models have FrameModel::BUFFER_COUNT buffers: one presented, at most one prepared and
+/// waiting, one the worker writes to and the rest caching frames. A newer prepared buffer replaces
+/// an older one. Only the latest requested position is prepared, so seeks arriving faster than
+/// frames are rendered, e.g. while dragging the frame slider, do not pile up.
+/// Buffers holding a whole frame, i.e. not interpolated, are kept as long as the cache stays below
+/// its memory budget when they are no longer presented or prepared. Seeking to a cached frame
+/// presents it without preparing it again. The least recently presented frame is evicted first.
+class FramePreparer
+{
+    enum class State { FREE, WRITING, READY, PRESENTED, CACHED };
+
+    struct Slot {
+        State state{State::FREE};
+        /// Replay position in frames stored in the buffer, NaN if none
+        double position{0};
+        /// TrajectoryData::getGeneration() of the frames stored in the buffer
+        unsigned int generation{0};
+        /// Bytes used by the arrays of the buffer in both models
+        size_t bytes{0};
+        /// Value of '_useCount' when the buffer was last prepared or presented
+        uint64_t lastUse{0};
+    };
+
+    TrajectoryData & _trajectories;
+    Frame2DModel & _model2D;
+    Frame3DModel & _model3D;
+    /// Only used by the worker
+    FrameInterpolator _interpolator{};
+
+    std::mutex _mutex{};
+    std::condition_variable _changed{};
+    std::array<Slot, FrameModel::BUFFER_COUNT> _slots{};
+    std::optional<double> _request{};
+    /// Bytes the buffers in state CACHED may use at most
+    size_t _cacheBudget;
+    unsigned int _generation{0};
+    uint64_t _useCount{0};
+    bool _write2D{true};
+    bool _write3D{true};
+    bool _stop{false};
+    std::thread _worker{};
+
+public:
+    /// Starts the worker thread, the models need to outlive the preparer
+    /// @param trajectories to read the frames from
+    /// @param model2D to write if selected with SetModels()
+    /// @param model3D to write if selected with SetModels()
+    /// @param cacheBudget bytes of the models' arrays kept for seeking at most
+    FramePreparer(
+        TrajectoryData & trajectories,
+        Frame2DModel & model2D,
+        Frame3DModel & model3D,
+        size_t cacheBudget = size_t{256} << 20);
+
+    /// Stops the worker thread
+    ~FramePreparer();
+
+    FramePreparer(const FramePreparer &) = delete;
+    FramePreparer & operator=(const FramePreparer &) = delete;
+
+    /// Selects the models written, the other ones keep their content. Prepared buffers are
+    /// discarded if the selection changes.
+    /// @param write2D prepare the 2D model
+    /// @param write3D prepare the 3D model
+    void SetModels(bool write2D, bool write3D);
+
+    /// Discards all prepared and cached buffers, e.g. because the model settings changed.
+    /// Waits for the worker to finish the buffer it writes to, afterwards the models may be
+    /// changed until the next call to Present() or Request().
+    void Invalidate();
+
+    /// Presents the frame at 'position', from the cache if it is held there
+    /// @param position replay position in frames
+    /// @param tolerance a prepared frame is presented if its position differs by at most this
+    void Present(double position, double tolerance);
+
+    /// Prepares the frame at 'position' in the background
+    /// @param position replay position in frames
+    void Request(double position);
+
+private:
+    void run();
+
+    /// @return the frame at 'position', interpolated if it lies between two frames
+    Frame frameAt(double position);
+
+    /// Waits until the worker is idle and discards all prepared buffers
+    /// @param lock holding '_mutex'
+    void discard(std::unique_lock<std::mutex> & lock);
+
+    /// Frees the cached buffers if the frames have been replaced since they were prepared,
+    /// '_mutex' needs to be held
+    void updateGeneration();
+
+    /// @return index of a slot in 'state' at 'position', -1 if none, '_mutex' needs to be held
+    int findSlot(State state, double position, double tolerance) const;
+
+    /// @return true if the frame at 'position' is presented, ready or cached, '_mutex' needs to be
+    /// held
+    bool isAvailable(double position) const;
+
+    /// Caches the buffer of 'slot' if it holds a whole frame, frees it otherwise. Evicts the least
+    /// recently used buffers if the cache exceeds its budget. '_mutex' needs to be held.
+    /// @param slot no longer presented or prepared
+    void release(Slot & slot);
+
+    /// @return index of a free slot for the worker, evicts a cached one if there is none. Free
+    /// buffers whose arrays are allocated already are preferred. '_mutex' needs to be held.
+    int acquire();
+
+    /// @return the cached slot presented the longest time ago, there needs to be one. '_mutex'
+    /// needs to be held.
+    Slot & leastRecentlyUsed();
+
+    /// Frees a cached slot, its buffer keeps its arrays to be written again
+    /// @return bytes used by the buffer of 'slot'
+    static size_t evict(Slot & slot);
+};
@@ -0,0 +1,79 @@
+#include "GlyphTensors.h"
+
+namespace
+{
+/// Sine and cosine of an angle given in degrees, accurate to about 1e-7 for angles within a few
+/// turns. The angle is reduced to the nearest quarter turn, the remainder in [-pi/4, pi/4] is
+/// evaluated with Taylor polynomials and the quadrant selects sign and order of the results.
+inline void sinCosDegrees(float degrees, float & sin, float & cos)
+{
+    // adding and subtracting 1.5 * 2^23 rounds to the nearest integer without a library call
+    constexpr float roundMagic = 12582912.f;
+    constexpr float halfPi     = 1.57079632679f;
+    const float quarters       = degrees * (1.f / 90.f);
+    const float quadrant       = (quarters + roundMagic) - roundMagic;
+    const float r              = (quarters - quadrant) * halfPi;
+    const float r2             = r * r;
+
+    const float s =
+        r * (1.f + r2 * (-1.f / 6.f + r2 * (1.f / 120.f + r2 * (-1.f / 5040.f))));
+    const float c =
+        1.f + r2 * (-1.f / 2.f + r2 * (1.f / 24.f + r2 * (-1.f / 720.f + r2 * (1.f / 40320.f))));
+
+    const int q = static_cast<int>(quadrant) & 3;
+    sin         = (q & 1) ? c : s;
+    cos         = (q & 1) ? s : c;
+    sin         = (q & 2) ? -sin : sin;
+    cos         = ((q + 1) & 2) ? -cos : cos;
+}
+} // namespace
+
+void computeGlyphTensors2D(
+    const float * radiusA,
+    const float * radiusB,
+    const float * angle,
+    size_t count,
+    float radiusScale,
+    float zScale,
+    float * tensors)
+{
+    for(size_t i = 0; i < count; ++i) {
+        float sin{};
+        float cos{};
+        sinCosDegrees(angle[i], sin, cos);
+        const float a = radiusA[i] * radiusScale;
+        const float b = radiusB[i] * radiusScale;
+
+        float * tensor = tensors + 9 * i;
+        tensor[0]      = a * cos;
+        tensor[1]      = a * sin;
+        tensor[2]      = 0.f;
+        tensor[3]      = -b * sin;
+        tensor[4]      = b * cos;
+        tensor[5]      = 0.f;
+        tensor[6]      = 0.f;
+        tensor[7]      = 0.f;
+        tensor[8]      = zScale;
+    }
+}
+
+void computeGlyphTensors3D(const float * angle, size_t count, float heightScale, float * tensors)
+{
+    for(size_t i = 0; i < count; ++i) {
+        float sin{};
+        float cos{};
+        sinCosDegrees(angle[i], sin, cos);
+
+        // rotX(90 degree) x rotZ swaps the last two rows of rotZ and negates the middle one
+        float * tensor = tensors + 9 * i;
+        tensor[0]      = cos;
+        tensor[1]      = sin;
+        tensor[2]      = 0.f;
+        tensor[3]      = 0.f;
+        tensor[4]      = 0.f;
+        tensor[5]      = -heightScale;
+        tensor[6]      = -sin;
+        tensor[7]      = cos;
+        tensor[8]      = 0.f;
+    }
+}
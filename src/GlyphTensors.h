@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+/// Batched computation of the 3x3 glyph tensors (scale x rotation, stored row wise as 9 floats
+/// per agent) used by the vtkTensorGlyph filters.
+/// Agents only rotate around the z axis, so the tensors reduce to a sine and a cosine per agent
+/// multiplied into constant patterns. The kernels work on plain float columns without branches
+/// or library calls in the loop body, which allows the compiler to vectorize them.
+
+/// Computes the tensors of agents drawn as ellipses in the x-y plane:
+/// diag(radiusA * radiusScale, radiusB * radiusScale, zScale) x rotZ(angle)
+/// @param radiusA semi axis in x direction per agent
+/// @param radiusB semi axis in y direction per agent
+/// @param angle rotation around the z axis in degrees per agent
+/// @param count number of agents
+/// @param radiusScale factor applied to both semi axes, i.e. 1 / radius of the glyph source
+/// @param zScale scale in z direction for all agents
+/// @param tensors output, 9 * count floats
+void computeGlyphTensors2D(
+    const float * radiusA,
+    const float * radiusB,
+    const float * angle,
+    size_t count,
+    float radiusScale,
+    float zScale,
+    float * tensors);
+
+/// Computes the tensors of agents drawn as cylinders standing upright:
+/// diag(1, heightScale, 1) x rotX(90 degree) x rotZ(angle)
+/// @param angle rotation around the z axis in degrees per agent
+/// @param count number of agents
+/// @param heightScale scale along the cylinder axis for all agents
+/// @param tensors output, 9 * count floats
+void computeGlyphTensors3D(const float * angle, size_t count, float heightScale, float * tensors);
@@ -0,0 +1,103 @@
+#include "ImageWriterPool.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <vtkImageData.h>
+#include <vtkPNGWriter.h>
+#include <vtkPointData.h>
+#include <vtkRenderWindow.h>
+#include <vtkUnsignedCharArray.h>
+
+ImageWriterPool::ImageWriterPool(unsigned int threads, size_t capacity) :
+    _capacity(std::max<size_t>(capacity, 1))
+{
+    if(threads == 0) {
+        // leave the other half to rendering and preparing the frames
+        threads = std::max(std::thread::hardware_concurrency() / 2, 1u);
+    }
+    for(unsigned int i = 0; i < threads; ++i) {
+        _workers.emplace_back(&ImageWriterPool::run, this);
+    }
+}
+
+ImageWriterPool::~ImageWriterPool()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _changed.notify_all();
+    for(auto & worker : _workers) {
+        worker.join();
+    }
+}
+
+void ImageWriterPool::Capture(vtkRenderWindow * window, const std::filesystem::path & path)
+{
+    vtkSmartPointer<vtkUnsignedCharArray> pixels;
+    {
+        std::unique_lock lock(_mutex);
+        _changed.wait(lock, [this]() { return _queue.size() < _capacity; });
+        if(!_buffers.empty()) {
+            pixels = std::move(_buffers.back());
+            _buffers.pop_back();
+        }
+    }
+    if(!pixels) {
+        pixels = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    }
+
+    // read the frame just rendered, the array is only reallocated if the window grew
+    const int * size = window->GetSize();
+    Job job{pixels, size[0], size[1], path};
+    window->GetPixelData(0, 0, job.width - 1, job.height - 1, 1, job.pixels);
+
+    {
+        std::lock_guard lock(_mutex);
+        _queue.push_back(std::move(job));
+    }
+    _changed.notify_all();
+}
+
+void ImageWriterPool::Flush()
+{
+    std::unique_lock lock(_mutex);
+    _changed.wait(lock, [this]() { return _queue.empty() && _writing == 0; });
+}
+
+void ImageWriterPool::run()
+{
+    auto image  = vtkSmartPointer<vtkImageData>::New();
+    auto writer = vtkSmartPointer<vtkPNGWriter>::New();
+    writer->SetInputData(image);
+
+    std::unique_lock lock(_mutex);
+    while(true) {
+        // the queue is drained before stopping
+        _changed.wait(lock, [this]() { return _stop || !_queue.empty(); });
+        if(_queue.empty()) {
+            return;
+        }
+        Job job = std::move(_queue.front());
+        _queue.pop_front();
+        ++_writing;
+        lock.unlock();
+        _changed.notify_all();
+
+        image->SetDimensions(job.width, job.height, 1);
+        image->GetPointData()->SetScalars(job.pixels);
+        writer->SetFileName(job.path.string().c_str());
+        writer->Write();
+        if(writer->GetErrorCode() != 0) {
+            Log::Warning("could not write <%s>", job.path.string().c_str());
+        }
+        // release the pixels before handing the buffer back
+        image->GetPointData()->SetScalars(nullptr);
+
+        lock.lock();
+        _buffers.push_back(std::move(job.pixels));
+        --_writing;
+        _changed.notify_all();
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <vtkSmartPointer.h>
+
+class vtkRenderWindow;
+class vtkUnsignedCharArray;
+
+/// Writes images of a render window as PNG files on a pool of worker threads.
+/// Capture() only reads the pixels back into a buffer on the calling thread, the render thread,
+/// compressing and writing the file is left to the workers. The buffers are reused for later
+/// captures. At most 'capacity' captured images wait for a worker, Capture() blocks while the
+/// queue is full so that a slow disk slows down the replay instead of filling the memory.
+class ImageWriterPool
+{
+    struct Job {
+        vtkSmartPointer<vtkUnsignedCharArray> pixels;
+        int width;
+        int height;
+        std::filesystem::path path;
+    };
+
+    const size_t _capacity;
+    std::mutex _mutex{};
+    std::condition_variable _changed{};
+    std::deque<Job> _queue{};
+    /// Buffers of written images, ready to be reused
+    std::vector<vtkSmartPointer<vtkUnsignedCharArray>> _buffers{};
+    /// Number of images taken from the queue and not yet written
+    size_t _writing{0};
+    bool _stop{false};
+    std::vector<std::thread> _workers{};
+
+public:
+    /// Starts the worker threads
+    /// @param threads number of workers, 0 uses half of the hardware threads
+    /// @param capacity number of captured images waiting for a worker at most
+    explicit ImageWriterPool(unsigned int threads = 0, size_t capacity = 8);
+
+    /// Writes the images captured so far and stops the worker threads
+    ~ImageWriterPool();
+
+    ImageWriterPool(const ImageWriterPool &) = delete;
+    ImageWriterPool & operator=(const ImageWriterPool &) = delete;
+
+    /// Reads the pixels of 'window' and queues them to be written to 'path'
+    /// @param window rendered window to capture
+    /// @param path of the PNG file, its directory needs to exist
+    void Capture(vtkRenderWindow * window, const std::filesystem::path & path);
+
+    /// Waits until all images captured so far are written
+    void Flush();
+
+private:
+    void run();
+};
@@ -0,0 +1,69 @@
+#include "LevelOfDetail.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vtkCamera.h>
+#include <vtkMath.h>
+#include <vtkRenderer.h>
+
+namespace
+{
+/// Agents smaller than this many pixels are drawn as density splats
+constexpr double densityPixels = 1.5;
+/// Agents smaller than this many pixels are drawn as sprites
+constexpr double spritePixels = 4;
+/// Agents smaller than this many pixels are drawn as low poly glyphs
+constexpr double lowPolyPixels = 12;
+/// More agents than this are drawn as sprites
+constexpr int spriteCount = 200000;
+/// More agents than this are drawn as low poly glyphs
+constexpr int lowPolyCount = 20000;
+/// Factor by which a threshold has to be passed to switch to a more detailed tier
+constexpr double hysteresis = 1.25;
+
+LodTier selectTier(double agentPixels, double agentCount)
+{
+    if(agentPixels < densityPixels) {
+        return LodTier::DENSITY;
+    }
+    if(agentPixels < spritePixels || agentCount > spriteCount) {
+        return LodTier::SPRITES;
+    }
+    if(agentPixels < lowPolyPixels || agentCount > lowPolyCount) {
+        return LodTier::LOW_POLY;
+    }
+    return LodTier::FULL;
+}
+} // namespace
+
+bool LevelOfDetail::Update(double agentPixels, int agentCount)
+{
+    auto tier = selectTier(agentPixels, agentCount);
+    if(tier < _tier) {
+        tier = std::max(tier, selectTier(agentPixels / hysteresis, agentCount * hysteresis));
+    }
+    if(tier == _tier) {
+        return false;
+    }
+    _tier = tier;
+    return true;
+}
+
+LodTier LevelOfDetail::Tier() const
+{
+    return _tier;
+}
+
+double pixelsPerWorldUnit(vtkRenderer * renderer)
+{
+    const int * size = renderer->GetSize();
+    auto * camera    = renderer->GetActiveCamera();
+    // the height of the viewport covers twice the parallel scale, or the height of the view
+    // frustum at the focal point
+    const double viewHeight =
+        camera->GetParallelProjection() ?
+            2 * camera->GetParallelScale() :
+            2 * camera->GetDistance() *
+                std::tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle()) / 2);
+    return viewHeight > 0 ? size[1] / viewHeight : 0;
+}
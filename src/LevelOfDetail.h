@@ -0,0 +1,39 @@
+#pragma once
+
+class vtkRenderer;
+
+/// Ways to draw the agents, from the most to the least detailed
+enum class LodTier {
+    /// 20 sided ellipses or cylinders, with direction cones
+    FULL,
+    /// 6 sided ellipses or cylinders, without direction cones
+    LOW_POLY,
+    /// one flat disc sprite per agent
+    SPRITES,
+    /// small additive gaussian splats, overlapping agents add up to a density image
+    DENSITY
+};
+
+/// Selects the LodTier from the size of an agent on screen and the number of agents.
+/// Small agents are drawn with less detail, many agents as well, as the geometry of each agent
+/// would cost more than it shows. To avoid switching back and forth while zooming or replaying
+/// near a threshold, a more detailed tier is only selected once the size or the number is
+/// clearly on the other side of the threshold.
+class LevelOfDetail
+{
+    LodTier _tier{LodTier::FULL};
+
+public:
+    /// Selects the tier for the current view
+    /// @param agentPixels diameter of a typical agent on screen in pixels
+    /// @param agentCount number of agents displayed
+    /// @return true if the tier changed
+    bool Update(double agentPixels, int agentCount);
+
+    /// @return the selected tier
+    LodTier Tier() const;
+};
+
+/// @param renderer to take the camera and the viewport from
+/// @return number of pixels covered on screen by one world unit at the focal point
+double pixelsPerWorldUnit(vtkRenderer * renderer);
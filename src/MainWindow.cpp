@@ -37,13 +37,17 @@
 #include "Log.h"
 #include "Parsing.h"
 #include "Settings.h"
+#include "TemporalPyramid.h"
+#include "TrajectoryCache.h"
 #include "TrajectoryPoint.h"
+#include "VideoWriter.h"
 #include "Visualisation.h"
 #include "geometry/FacilityGeometry.h"
 
 #include <QApplication>
 #include <QCloseEvent>
 #include <QColorDialog>
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
 #include <QFileDialog>
@@ -60,6 +64,7 @@
 #include <QTemporaryFile>
 #include <QThread>
 #include <QTime>
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
 #include <limits>
@@ -67,6 +72,12 @@
 #include <string>
 #include <vector>
 
+namespace
+{
+/// Number of summaries of the frames the sparkline of the frame slider is drawn from at most
+constexpr size_t maxTimelineNodes = 4096;
+} // namespace
+
 //////////////////////////////////////////////////////////////////////////////
 // Creation & Destruction
 //////////////////////////////////////////////////////////////////////////////
@@ -103,6 +114,10 @@ MainWindow::MainWindow(QWidget * parent, std::optional<std::filesystem::path> pa
         &QAction::triggered,
         this,
         &MainWindow::slotSetCameraPerspectiveToSideRotate);
+    connect(ui.actionTrail_Length, &QAction::triggered, this, &MainWindow::slotSetTrailLength);
+    connect(
+        ui.actionOutput_Directory, &QAction::triggered, this, &MainWindow::slotSetOutputDirectory);
+    connect(ui.actionFiles_Prefix, &QAction::triggered, this, &MainWindow::slotSetFilesPrefix);
 
     labelCurrentFile.setFrameStyle(QFrame::Panel | QFrame::Sunken);
     labelCurrentFile.setText("File: -");
@@ -115,6 +130,43 @@ MainWindow::MainWindow(QWidget * parent, std::optional<std::filesystem::path> pa
     labelRecording.setFrameStyle(QFrame::Panel | QFrame::Sunken);
     labelRecording.setText(" rec: off ");
     statusBar()->addPermanentWidget(&labelRecording);
+
+    // only visible while a trajectory file is loaded in the background
+    loadingProgress.setRange(0, 100);
+    loadingProgress.setMaximumWidth(150);
+    loadingProgress.setVisible(false);
+    statusBar()->addPermanentWidget(&loadingProgress);
+    loadingCancel.setText(tr("Cancel"));
+    loadingCancel.setToolTip(tr("Stop loading, the frames loaded so far are kept"));
+    loadingCancel.setVisible(false);
+    statusBar()->addPermanentWidget(&loadingCancel);
+    connect(&loadingCancel, &QPushButton::clicked, this, &MainWindow::slotCancelLoading);
+    connect(
+        &_loader, &TrajectoryLoader::progressChanged, this, &MainWindow::slotLoadingProgress);
+    connect(&_loader, &TrajectoryLoader::finished, this, &MainWindow::slotLoadingFinished);
+    connect(ui.actionOut_of_Core_Loading, &QAction::toggled, [this](bool checked) {
+        _settings.outOfCore = checked;
+    });
+    connect(ui.actionFollow_File, &QAction::toggled, [this](bool checked) {
+        _settings.followFile = checked;
+    });
+    connect(ui.actionPin_to_Newest_Frame, &QAction::toggled, [this](bool checked) {
+        _settings.pinToNewestFrame = checked;
+        if(checked && _follower.isFollowing()) {
+            slotFramesAppended(_trajectories.getFrameCount());
+        }
+    });
+    connect(&_follower, &TrajectoryFollower::framesAppended, this, &MainWindow::slotFramesAppended);
+    connect(ui.actionInstanced_Agent_Rendering, &QAction::toggled, [this](bool checked) {
+        _settings.instancedAgents = checked;
+        _visualisation->setInstancedAgents(checked);
+    });
+    connect(ui.actionInterpolate_Frames, &QAction::toggled, [this](bool checked) {
+        _settings.interpolateFrames = checked;
+    });
+    connect(ui.actionLevel_of_Detail, &QAction::toggled, [this](bool checked) {
+        _settings.levelOfDetail = checked;
+    });
     // restore the settings
     loadAllSettings();
     if(path)
@@ -184,12 +236,23 @@ void MainWindow::slotRewindFramesToBegin()
 void MainWindow::slotUpdateNumFrames(int num_frames)
 {
     ui.framesIndicatorSlider->setMaximum(num_frames - 1);
+    ui.framesIndicatorSlider->setSingleStep(1 << sliderLevel());
+
+    // a few summaries per pixel are enough for the sparkline, independent of the number of frames
+    const int level =
+        TemporalPyramid::levelForNodeCount(std::max(num_frames, 0), maxTimelineNodes);
+    ui.framesIndicatorSlider->setSummaries(_trajectories.getSummaries(level), level);
 }
 
 
-void MainWindow::slotSetReplaySpeed(int frames_per_iteration)
+void MainWindow::slotSetReplaySpeed(int speed)
 {
-    _visualisation->ChangeReplaySpeed(frames_per_iteration);
+    if(speed == 0) {
+        // skip 0 in the direction the value is changed, this calls the slot again
+        ui.replaySpeedSelector->setValue(_visualisation->replaySpeed() > 0 ? -1 : 1);
+        return;
+    }
+    _visualisation->ChangeReplaySpeed(speed);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -317,6 +380,8 @@ bool MainWindow::tryParseFile(const std::filesystem::path & path)
             return tryParseGeometry(path);
         case Parsing::InputFileType::TRAJECTORIES_TXT:
             return tryParseTrajectory(path);
+        case Parsing::InputFileType::TRAJECTORIES_TXT_CACHED:
+            return tryParseTrajectory(path, true);
         case Parsing::InputFileType::UNRECOGNIZED:
             return false;
     }
@@ -342,7 +407,7 @@ bool MainWindow::tryParseGeometry(const std::filesystem::path & path)
     return Parsing::readJpsGeometryXml(path, _visualisation->getGeometry());
 }
 
-bool MainWindow::tryParseTrajectory(const std::filesystem::path & path)
+bool MainWindow::tryParseTrajectory(const std::filesystem::path & path, bool fromCache)
 {
     const auto parent_path       = path.parent_path();
     auto fileName                = QString::fromStdString(path.string());
@@ -416,26 +481,87 @@ bool MainWindow::tryParseTrajectory(const std::filesystem::path & path)
     for(auto tab : trainTypes)
         Log::Info("type: %s\n", tab.first.c_str());
 
-    _trajectories.clearFrames();
-    if(false == Parsing::ParseTxtFormat(fileName, &_trajectories)) {
+    if(_settings.followFile) {
+        if(false == _follower.start(fileName, &_trajectories)) {
+            return false;
+        }
+        statusBar()->showMessage(tr("following file"));
+        return true;
+    }
+
+    if(fromCache) {
+        if(Parsing::loadTrajectoryCache(path, &_trajectories)) {
+            statusBar()->showMessage(tr("file loaded from cache"));
+            return true;
+        }
+        Log::Warning("Could not load trajectory cache, parsing <%s>", path.string().c_str());
+    }
+
+    if(false == _loader.start(fileName, &_trajectories, _settings.outOfCore)) {
         return false;
     }
 
-    statusBar()->showMessage(tr("file loaded and parsed"));
+    loadingProgress.setValue(0);
+    loadingProgress.setVisible(true);
+    loadingCancel.setVisible(true);
+    statusBar()->showMessage(tr("loading file..."));
 
     return true;
 }
 
+void MainWindow::slotLoadingProgress(int percent)
+{
+    loadingProgress.setValue(percent);
+}
+
+void MainWindow::slotLoadingFinished(bool success)
+{
+    loadingProgress.setVisible(false);
+    loadingCancel.setVisible(false);
+    if(success) {
+        statusBar()->showMessage(tr("file loaded and parsed"));
+    } else {
+        statusBar()->showMessage(tr("file could not be loaded"));
+    }
+}
+
+void MainWindow::slotFramesAppended(int frameCount)
+{
+    if(_settings.pinToNewestFrame && frameCount > 0) {
+        _trajectories.moveToFrame(frameCount - 1);
+    }
+}
+
+void MainWindow::slotCancelLoading()
+{
+    _loader.cancel();
+    loadingProgress.setVisible(false);
+    loadingCancel.setVisible(false);
+    statusBar()->showMessage(tr("loading cancelled"));
+}
+
 void MainWindow::slotToggleRecording(bool checked)
 {
     if(checked) {
+        const QString fileName = QDir(_settings.outputDirectory)
+                                     .filePath(
+                                         _settings.filesPrefix + "jpsvis_" +
+                                         QDateTime::currentDateTime().toString("yyMMdd_hhmmss") +
+                                         ".mp4");
+        if(!_visualisation->startRecording(fileName.toStdString())) {
+            ui.BtRecord->setChecked(false);
+            slotErrorOutput("Could not start recording, is ffmpeg installed?");
+            return;
+        }
         ui.BtRecord->setToolTip("Stop Recording");
         labelRecording.setText(" rec: on ");
-        // TODO(kkratz): Call visualization to start recording. This is not yet implemented
+        statusBar()->showMessage(QString("recording to %1").arg(fileName));
     } else {
         ui.BtRecord->setToolTip("Start Recording");
         labelRecording.setText(" rec: off ");
-        // TODO(kkratz): Call visualization to start recording. This is not yet implemented
+        if(!_visualisation->stopRecording()) {
+            slotErrorOutput("The video could not be encoded");
+        }
     }
 }
 
@@ -494,6 +620,7 @@ void MainWindow::resetGraphicalElements()
 void MainWindow::slotShowTrajectoryOnly()
 {
     _settings.showTrajectories = ui.actionShow_Trajectories->isChecked();
+    _visualisation->invalidate(Visualisation::DIRTY_SETTINGS);
 }
 
 void MainWindow::slotShowPedestrianOnly()
@@ -503,6 +630,7 @@ void MainWindow::slotShowPedestrianOnly()
     } else {
         _settings.showAgents = false;
     }
+    _visualisation->invalidate(Visualisation::DIRTY_SETTINGS);
 }
 
 void MainWindow::slotShowGeometry()
@@ -549,11 +677,23 @@ void MainWindow::slotShowHideFloor()
 
 void MainWindow::slotUpdateFrameSlider(int newValue)
 {
-    _trajectories.moveToFrame(newValue);
+    // the frames between two pixels of the slider can not be reached by dragging anyway
+    _trajectories.moveToFrame(TemporalPyramid::snapToLevel(newValue, sliderLevel()));
+}
+
+int MainWindow::sliderLevel() const
+{
+    const double framesPerPixel = (ui.framesIndicatorSlider->maximum() + 1.0) /
+                                  std::max(ui.framesIndicatorSlider->width(), 1);
+    return TemporalPyramid::levelForStride(framesPerPixel);
 }
 
 void MainWindow::unloadData()
 {
+    _loader.cancel();
+    _follower.stop();
+    loadingProgress.setVisible(false);
+    loadingCancel.setVisible(false);
     // extern_trajectories_firstSet.clear();
     _trajectories.clearFrames();
     _trajectories.resetFrameCursor();
@@ -585,6 +725,7 @@ void MainWindow::slotToogle2D()
     _settings.mode = mode;
     bool status    = mode == RenderMode::MODE_2D && _settings.showGeometry;
     _visualisation->setGeometryVisibility2D(status);
+    _visualisation->invalidate(Visualisation::DIRTY_SETTINGS);
 }
 
 /// set visualisation mode to 3D
@@ -602,6 +743,7 @@ void MainWindow::slotToogle3D()
     _settings.mode = mode;
     bool status    = mode == RenderMode::MODE_3D && _settings.showGeometry;
     _visualisation->setGeometryVisibility3D(status);
+    _visualisation->invalidate(Visualisation::DIRTY_SETTINGS);
 }
 
 void MainWindow::slotNextFrame()
@@ -619,11 +761,13 @@ void MainWindow::slotPreviousFrame()
 void MainWindow::slotShowPedestrianCaption()
 {
     _settings.showAgentsCaptions = ui.actionShow_Captions->isChecked();
+    _visualisation->invalidate(Visualisation::DIRTY_SETTINGS);
 }
 
 void MainWindow::slotTogglePedestrianDirections(bool is_enabled)
 {
     _settings.showAgentDirections = is_enabled;
+    _visualisation->invalidate(Visualisation::DIRTY_SETTINGS);
 }
 
 void MainWindow::slotToogleShowAxis()
@@ -770,6 +914,49 @@ void MainWindow::slotSetCameraPerspectiveToSideRotate()
     }
 }
 
+void MainWindow::slotSetTrailLength()
+{
+    bool ok         = false;
+    double duration = QInputDialog::getDouble(
+        this,
+        "Trail length",
+        "Time span covered by the trails [s]:",
+        _settings.trailDuration,
+        0.1,
+        3600,
+        1,
+        &ok);
+    if(ok) {
+        _settings.trailDuration = duration;
+        _visualisation->invalidate(Visualisation::DIRTY_SETTINGS);
+    }
+}
+
+void MainWindow::slotSetOutputDirectory()
+{
+    const QString directory = QFileDialog::getExistingDirectory(
+        this, "Select the directory for screenshots and videos", _settings.outputDirectory);
+    if(!directory.isEmpty()) {
+        _settings.outputDirectory = directory;
+        Log::Info("Output directory: %s", directory.toStdString().c_str());
+    }
+}
+
+void MainWindow::slotSetFilesPrefix()
+{
+    bool ok              = false;
+    const QString prefix = QInputDialog::getText(
+        this,
+        "Files prefix",
+        "Prefix of the screenshot and video file names:",
+        QLineEdit::Normal,
+        _settings.filesPrefix,
+        &ok);
+    if(ok) {
+        _settings.filesPrefix = prefix;
+    }
+}
+
 void MainWindow::slotErrorOutput(QString err)
 {
     QMessageBox msgBox;
@@ -823,6 +1010,10 @@ void MainWindow::loadAllSettings()
         _settings.showTrajectories = checked;
         Log::Info("show Trajectories: %s", checked ? "Yes" : "No");
     }
+    if(settings.contains("view/trailDuration")) {
+        _settings.trailDuration = settings.value("view/trailDuration").toDouble();
+        Log::Info("trail duration: %.1f s", _settings.trailDuration);
+    }
     if(settings.contains("view/showGeometry")) {
         bool checked = settings.value("view/showGeometry").toBool();
         ui.actionShow_Geometry->setChecked(checked);
@@ -860,6 +1051,51 @@ void MainWindow::loadAllSettings()
         Log::Info("show OnScreensInfos: %s", checked ? "Yes" : "No");
     }
     // options
+    if(settings.contains("options/outOfCore")) {
+        bool checked = settings.value("options/outOfCore").toBool();
+        ui.actionOut_of_Core_Loading->setChecked(checked);
+        _settings.outOfCore = checked;
+        Log::Info("out-of-core loading: %s", checked ? "Yes" : "No");
+    }
+    if(settings.contains("options/followFile")) {
+        bool checked = settings.value("options/followFile").toBool();
+        ui.actionFollow_File->setChecked(checked);
+        _settings.followFile = checked;
+        Log::Info("follow file: %s", checked ? "Yes" : "No");
+    }
+    if(settings.contains("options/pinToNewestFrame")) {
+        bool checked = settings.value("options/pinToNewestFrame").toBool();
+        ui.actionPin_to_Newest_Frame->setChecked(checked);
+        _settings.pinToNewestFrame = checked;
+        Log::Info("pin to newest frame: %s", checked ? "Yes" : "No");
+    }
+    if(settings.contains("options/instancedAgents")) {
+        bool checked = settings.value("options/instancedAgents").toBool();
+        ui.actionInstanced_Agent_Rendering->setChecked(checked);
+        _settings.instancedAgents = checked;
+        Log::Info("instanced agent rendering: %s", checked ? "Yes" : "No");
+    }
+    if(settings.contains("options/interpolateFrames")) {
+        bool checked = settings.value("options/interpolateFrames").toBool();
+        ui.actionInterpolate_Frames->setChecked(checked);
+        _settings.interpolateFrames = checked;
+        Log::Info("interpolate frames: %s", checked ? "Yes" : "No");
+    }
+    if(settings.contains("options/levelOfDetail")) {
+        bool checked = settings.value("options/levelOfDetail").toBool();
+        ui.actionLevel_of_Detail->setChecked(checked);
+        _settings.levelOfDetail = checked;
+        Log::Info("automatic level of detail: %s", checked ? "Yes" : "No");
+    }
+    if(settings.contains("options/outputDirectory")) {
+        _settings.outputDirectory = settings.value("options/outputDirectory").toString();
+        Log::Info("Output directory: %s", _settings.outputDirectory.toStdString().c_str());
+    }
+
+    if(settings.contains("options/filesPrefix")) {
+        _settings.filesPrefix = settings.value("options/filesPrefix").toString();
+    }
+
     if(settings.contains("options/rememberSettings")) {
         bool checked = settings.value("options/rememberSettings").toBool();
         ui.actionRemember_Settings->setChecked(checked);
@@ -902,6 +1138,7 @@ void MainWindow::saveAllSettings()
     settings.setValue("view/showCaptions", _settings.showAgentsCaptions);
     settings.setValue("view/showDirections", _settings.showAgentDirections);
     settings.setValue("view/showTrajectories", _settings.showTrajectories);
+    settings.setValue("view/trailDuration", _settings.trailDuration);
     settings.setValue("view/showGeometry", _settings.showGeometry);
     settings.setValue("view/showFloor", _settings.showFloor);
     settings.setValue("view/showWalls", _settings.showWalls);
@@ -911,21 +1148,25 @@ void MainWindow::saveAllSettings()
 
     // options: the color settings are saved in the methods where they are used.
     settings.setValue("options/rememberSettings", ui.actionRemember_Settings->isChecked());
+    settings.setValue("options/outOfCore", _settings.outOfCore);
+    settings.setValue("options/followFile", _settings.followFile);
+    settings.setValue("options/pinToNewestFrame", _settings.pinToNewestFrame);
+    settings.setValue("options/instancedAgents", _settings.instancedAgents);
+    settings.setValue("options/interpolateFrames", _settings.interpolateFrames);
+    settings.setValue("options/levelOfDetail", _settings.levelOfDetail);
+    settings.setValue("options/outputDirectory", _settings.outputDirectory);
+    settings.setValue("options/filesPrefix", _settings.filesPrefix);
 }
 
 /// start/stop the recording process als png images sequences
 void MainWindow::slotRecordPNGsequence()
 {
-    // TODO(kkz) disabled
-    if(true) {
-        slotErrorOutput("Start a video first");
-    }
-
     // get the status from the system settings and toogle it
     bool status = _settings.recordPNGsequence;
 
     if(status) {
         ui.actionRecord_PNG_sequences->setText("Record PNG sequence");
+        _visualisation->finishScreenshotSequence();
     } else {
         ui.actionRecord_PNG_sequences->setText("Stop PNG Recording");
     }
@@ -937,7 +1178,32 @@ void MainWindow::slotRecordPNGsequence()
 /// render a PNG image sequence to an AVI video
 void MainWindow::slotRenderPNG2AVI()
 {
-    slotErrorOutput("Not Implemented yet, sorry !");
+    const auto firstImage = QFileDialog::getOpenFileName(
+        this,
+        "Select the first image of the sequence",
+        _settings.outputDirectory,
+        "PNG Images (*.png)");
+    if(firstImage.isNull()) {
+        return;
+    }
+    // the video is placed next to the directory holding the sequence
+    const std::filesystem::path path{firstImage.toStdString()};
+    const auto output = path.parent_path().string() + ".avi";
+    const double fps  = _visualisation->trajectoryRecordingFps() > 0 ?
+                            _visualisation->trajectoryRecordingFps() :
+                            PlaybackClock::MAX_DISPLAY_RATE;
+
+    statusBar()->showMessage(tr("encoding video..."));
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const bool success = VideoWriter::EncodeImageSequence(path, output, fps);
+    QApplication::restoreOverrideCursor();
+    if(success) {
+        statusBar()->showMessage(
+            QString("video written to %1").arg(QString::fromStdString(output)));
+    } else {
+        statusBar()->showMessage(tr("video could not be encoded"));
+        slotErrorOutput("Could not encode the images, is ffmpeg installed?");
+    }
 }
 
 void MainWindow::dragEnterEvent(QDragEnterEvent * event)
@@ -988,6 +1254,7 @@ void MainWindow::slotOnGeometryItemChanged(QStandardItem * item)
         int subr   = l[1].toInt();
         bool state = item->checkState();
         _visualisation->getGeometry().UpdateVisibility(room, subr, state);
+        _visualisation->invalidate(Visualisation::DIRTY_SETTINGS);
     } else {
         for(int i = 0; i < item->rowCount(); i++) {
             QStandardItem * child = item->child(i);
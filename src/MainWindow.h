@@ -34,12 +34,16 @@
 #include "ApplicationState.h"
 #include "Settings.h"
 #include "TrajectoryData.h"
+#include "TrajectoryFollower.h"
+#include "TrajectoryLoader.h"
 #include "Visualisation.h"
 #include "myqtreeview.h"
 #include "ui_mainwindow.h"
 
 #include <QLabel>
 #include <QMainWindow>
+#include <QProgressBar>
+#include <QPushButton>
 #include <QSettings>
 #include <QSplitter>
 #include <QStandardItem>
@@ -79,10 +83,10 @@ public slots:
     /// Update the number of total frames
     void slotUpdateNumFrames(int num_frames);
 
-    /// Sets the number of data frames that will be advanced per iteration on the renderer. I.e. a
-    /// replay speed of 6 means only every 6th data frame will be shown.
-    /// @frames_per_iteration number of frames that the data advances per render call.
-    void slotSetReplaySpeed(int frames_per_iteration);
+    /// Sets the replay speed, i.e. the replayed seconds per second. A negative speed replays the
+    /// trajectories backwards, 0 is skipped.
+    /// @param speed replayed seconds per second
+    void slotSetReplaySpeed(int speed);
 
     /// OLD SLOTS
     /// display the help modus
@@ -99,6 +103,15 @@ public slots:
     void slotSetCameraPerspectiveToTopRotate();
     void slotSetCameraPerspectiveToSideRotate();
 
+    /// ask for the time span covered by the agent trails
+    void slotSetTrailLength();
+
+    /// ask for the directory screenshots, image sequences and videos are written to
+    void slotSetOutputDirectory();
+
+    /// ask for the prefix of the screenshot, image sequence and video file names
+    void slotSetFilesPrefix();
+
     // controls visualisation
     void slotToggleRecording(bool checked);
     /// take a screenshot of the rendering window
@@ -182,6 +195,21 @@ public slots:
 
     void slotMousePositionUpdated(double x, double y, double z);
 
+    /// Update the progress of a trajectory file being loaded in the background
+    /// @param percent of the file loaded
+    void slotLoadingProgress(int percent);
+
+    /// Called once a trajectory file has been loaded completely
+    /// @param success false if the file could not be loaded
+    void slotLoadingFinished(bool success);
+
+    /// Stops loading the trajectory file, frames loaded so far are kept
+    void slotCancelLoading();
+
+    /// Called when frames have been appended to a followed trajectory file
+    /// @param frameCount number of frames available now
+    void slotFramesAppended(int frameCount);
+
 protected:
     virtual void closeEvent(QCloseEvent * event);
     void dragEnterEvent(QDragEnterEvent * event);
@@ -211,7 +239,9 @@ private:
     bool tryParseFile(const std::filesystem::path & path = {});
     void tryLoadFile(const std::filesystem::path & path);
     bool tryParseGeometry(const std::filesystem::path & path);
-    bool tryParseTrajectory(const std::filesystem::path & path);
+    /// @param path to the trajectory txt file
+    /// @param fromCache load the frames from the binary cache of the file instead of parsing it
+    bool tryParseTrajectory(const std::filesystem::path & path, bool fromCache = false);
 
     /// return true if at least one dataset was loaded
     bool anyDatasetLoaded();
@@ -223,15 +253,23 @@ private:
     void resetAllFrameCursor();
     void SetAppInfos();
 
+    /// @return the level of the temporal pyramid matching the frames covered by a pixel of the
+    /// frame slider, see TemporalPyramid
+    int sliderLevel() const;
+
 private:
     Ui::mainwindow ui;
     ApplicationState _state{ApplicationState::NoData};
     Settings _settings;
     TrajectoryData _trajectories;
+    TrajectoryLoader _loader;
+    TrajectoryFollower _follower;
     std::unique_ptr<Visualisation> _visualisation;
     QLabel labelFrameNumber;
     QLabel labelRecording;
     QLabel labelCurrentFile;
+    QProgressBar loadingProgress;
+    QPushButton loadingCancel;
     QSplitter _splitter;
     MyQTreeView _geoStructure;
 };
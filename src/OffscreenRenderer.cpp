@@ -0,0 +1,137 @@
+#include "OffscreenRenderer.h"
+
+#include "Log.h"
+#include "Parsing.h"
+#include "Settings.h"
+#include "TrajectoryCache.h"
+#include "TrajectoryData.h"
+#include "Visualisation.h"
+
+#include <QString>
+#include <algorithm>
+#include <optional>
+#include <vtkRenderWindow.h>
+#include <vtkSmartPointer.h>
+
+namespace
+{
+/// Perspectives of Visualisation::setCameraPerspective()
+constexpr int topPerspective        = 1;
+constexpr int topRotatedPerspective = 2;
+constexpr int sidePerspective       = 3;
+
+struct CameraView {
+    int perspective;
+    int degrees;
+};
+
+/// @param camera see RenderOptions::camera
+/// @return the view, nothing if 'camera' is malformed
+std::optional<CameraView> parseCamera(const std::string & camera)
+{
+    const auto separator = camera.find(':');
+    const auto name      = camera.substr(0, separator);
+    int degrees{0};
+    if(separator != std::string::npos) {
+        bool ok{false};
+        degrees = QString::fromStdString(camera.substr(separator + 1)).toInt(&ok);
+        if(!ok) {
+            return std::nullopt;
+        }
+    }
+    if(name == "top") {
+        return CameraView{degrees == 0 ? topPerspective : topRotatedPerspective, degrees};
+    }
+    if(name == "side") {
+        return CameraView{sidePerspective, degrees};
+    }
+    return std::nullopt;
+}
+
+/// Loads 'trajectory' and the geometry referenced in its header, synchronously
+/// @return true on success
+bool loadTrajectory(
+    const std::filesystem::path & trajectory,
+    Visualisation & visualisation,
+    TrajectoryData & trajectories)
+{
+    const auto fileType = Parsing::detectFileType(trajectory);
+    if(fileType != Parsing::InputFileType::TRAJECTORIES_TXT &&
+       fileType != Parsing::InputFileType::TRAJECTORIES_TXT_CACHED) {
+        Log::Error("<%s> is not a trajectory file", trajectory.string().c_str());
+        return false;
+    }
+
+    const auto additionalInputs = Parsing::extractAdditionalInputFilePaths(trajectory);
+    if(additionalInputs.geometry_path &&
+       !Parsing::readJpsGeometryXml(
+           additionalInputs.geometry_path.value(), visualisation.getGeometry())) {
+        Log::Error(
+            "could not load the geometry <%s>",
+            additionalInputs.geometry_path.value().string().c_str());
+        return false;
+    }
+
+    if(fileType == Parsing::InputFileType::TRAJECTORIES_TXT_CACHED &&
+       Parsing::loadTrajectoryCache(trajectory, &trajectories)) {
+        return true;
+    }
+    return Parsing::ParseTxtFormat(QString::fromStdString(trajectory.string()), &trajectories);
+}
+} // namespace
+
+int renderOffscreen(const std::filesystem::path & trajectory, const RenderOptions & options)
+{
+    const auto view = parseCamera(options.camera);
+    if(!view) {
+        Log::Error(
+            "unknown camera <%s>, expected top, top:<degrees> or side:<degrees>",
+            options.camera.c_str());
+        return 1;
+    }
+
+    Settings settings;
+    settings.mode = view->perspective == sidePerspective ? RenderMode::MODE_3D :
+                                                            RenderMode::MODE_2D;
+    TrajectoryData trajectories;
+
+    auto window = vtkSmartPointer<vtkRenderWindow>::New();
+    window->SetOffScreenRendering(true);
+    window->SetSize(options.width, options.height);
+    Visualisation visualisation(nullptr, window, &settings, &trajectories);
+
+    if(!loadTrajectory(trajectory, visualisation, trajectories)) {
+        return 1;
+    }
+    const int frameCount = trajectories.getFrameCount();
+    const int first      = std::max(options.from, 0);
+    int last             = frameCount - 1;
+    if(options.to >= 0) {
+        last = std::min(options.to, last);
+    }
+    if(first > last) {
+        Log::Error(
+            "no frames to render in [%d, %d] of %d frames", options.from, options.to, frameCount);
+        return 1;
+    }
+
+    visualisation.start();
+    visualisation.setCameraPerspective(view->perspective, view->degrees);
+    if(!visualisation.startRecording(options.output)) {
+        visualisation.stop();
+        return 1;
+    }
+
+    const int progressInterval = std::max((last - first + 1) / 10, 1);
+    for(int frame = first; frame <= last; ++frame) {
+        trajectories.moveToFrame(frame);
+        visualisation.onExecute();
+        if((frame - first + 1) % progressInterval == 0) {
+            Log::Info("rendered frame %d of [%d, %d]", frame, first, last);
+        }
+    }
+
+    const bool success = visualisation.stopRecording();
+    visualisation.stop();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+/// Options of the headless rendering, see renderOffscreen()
+struct RenderOptions {
+    /// Video file, or first image of a PNG sequence if it ends in ".png", see VideoWriter
+    std::filesystem::path output{};
+    /// First frame rendered
+    int from{0};
+    /// Last frame rendered, -1 renders up to the last frame of the trajectory
+    int to{-1};
+    /// "top" for the 2D top view, "top:<degrees>" rotates it around the view axis,
+    /// "side:<degrees>" shows the 3D scene elevated by the given angle
+    std::string camera{"top"};
+    /// Size of the frames in pixels
+    int width{1920};
+    int height{1080};
+};
+
+/// Renders the frames of a trajectory into a video without opening a window.
+/// The scene is set up as in the GUI with the default settings and rendered into an offscreen
+/// render window. With VTK built against OSMesa or EGL this needs neither a display nor a GPU,
+/// e.g. on the nodes of a cluster.
+/// @param trajectory txt file to render, the geometry referenced in its header is loaded as well
+/// @param options of the output
+/// @return exit code of the application, 0 on success
+int renderOffscreen(const std::filesystem::path & trajectory, const RenderOptions & options);
@@ -0,0 +1,206 @@
+#include "OutOfCoreTrajectory.h"
+
+#include "FrameBlock.h"
+#include "Log.h"
+#include "TxtParsing.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+
+OutOfCoreTrajectory::OutOfCoreTrajectory(
+    std::shared_ptr<const void> mapping,
+    std::string_view data,
+    Parsing::TxtLayout layout,
+    size_t windowSize) :
+    _mapping(std::move(mapping)),
+    _data(data),
+    _layout(std::move(layout)),
+    _windowSize(std::max<size_t>(windowSize, 4))
+{
+    _prefetcher = std::thread([this]() { prefetch(); });
+}
+
+OutOfCoreTrajectory::~OutOfCoreTrajectory()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _cursorChanged.notify_one();
+    _prefetcher.join();
+}
+
+bool OutOfCoreTrajectory::buildIndex(
+    const std::atomic<bool> & cancel,
+    const std::function<void(double)> & progress)
+{
+    // New offsets are published in batches to keep the lock contention low
+    constexpr size_t publishInterval = 1 << 20;
+    const char * const begin         = _data.data();
+    const char * const end           = begin + _data.size();
+    const char * cur                 = begin;
+    size_t nextPublish               = publishInterval;
+    std::vector<uint64_t> newOffsets{};
+    std::optional<int> lastFrameID{};
+    while(cur < end) {
+        if(cancel) {
+            return false;
+        }
+        const auto * eol  = static_cast<const char *>(memchr(cur, '\n', end - cur));
+        const char * next = eol ? eol + 1 : end;
+        int frameID{0};
+        if(Parsing::parseTxtFrameID(std::string_view(cur, (eol ? eol : end) - cur), frameID)) {
+            if(!lastFrameID || frameID > lastFrameID.value()) {
+                newOffsets.push_back(static_cast<uint64_t>(cur - begin));
+                lastFrameID = frameID;
+            } else if(frameID < lastFrameID.value()) {
+                Log::Warning(
+                    "Trajectory data is not ordered by frame (frame %d after frame %d), it cannot "
+                    "be replayed out-of-core",
+                    frameID,
+                    lastFrameID.value());
+                return false;
+            }
+        }
+        cur = next;
+        if(static_cast<size_t>(cur - begin) >= nextPublish || cur == end) {
+            {
+                std::lock_guard lock(_mutex);
+                _frameOffsets.insert(_frameOffsets.end(), newOffsets.begin(), newOffsets.end());
+                _indexedEnd = static_cast<uint64_t>(cur - begin);
+            }
+            newOffsets.clear();
+            nextPublish += publishInterval;
+            progress(static_cast<double>(cur - begin) / _data.size());
+        }
+    }
+    std::lock_guard lock(_mutex);
+    _indexComplete = true;
+    Log::Info("Indexed %zu frames for out-of-core replay", _frameOffsets.size());
+    return true;
+}
+
+int OutOfCoreTrajectory::frameCount() const
+{
+    std::lock_guard lock(_mutex);
+    return completeFrameCount();
+}
+
+Frame OutOfCoreTrajectory::frame(int index)
+{
+    std::unique_lock lock(_mutex);
+    if(index < 0 || index >= completeFrameCount()) {
+        return Frame{};
+    }
+    if(const auto iter = _window.find(index); iter != _window.end()) {
+        return iter->second;
+    }
+    const auto text = frameText(index);
+    lock.unlock();
+    auto decoded = decode(text);
+    lock.lock();
+    // Random access far from the cursor does not pollute the window
+    if(static_cast<size_t>(std::abs(index - _cursor)) <= _windowSize) {
+        _window.emplace(index, decoded);
+    }
+    return decoded;
+}
+
+void OutOfCoreTrajectory::setCursor(int cursor, int direction)
+{
+    {
+        std::lock_guard lock(_mutex);
+        _cursor      = cursor;
+        _direction   = direction == 0 ? _direction : direction;
+        _cursorMoved = true;
+    }
+    _cursorChanged.notify_one();
+}
+
+size_t OutOfCoreTrajectory::memoryUsage() const
+{
+    std::lock_guard lock(_mutex);
+    size_t bytes = _frameOffsets.capacity() * sizeof(uint64_t);
+    for(const auto & [index, frame] : _window) {
+        bytes += frame.Block()->memoryUsage() + sizeof(frame);
+    }
+    return bytes;
+}
+
+Frame OutOfCoreTrajectory::decode(std::string_view text) const
+{
+    std::vector<FrameElement> elements{};
+    Parsing::TxtRecord record{};
+    Parsing::withTxtRecordParser(_layout, [&text, &elements, &record](auto parseRecord) {
+        Parsing::forEachLine(text, [&elements, &record, &parseRecord](std::string_view line) {
+            if(parseRecord(line, record)) {
+                elements.emplace_back(record.element);
+            }
+        });
+    });
+    auto block = std::make_shared<FrameBlock>();
+    block->reserve(1, elements.size());
+    block->appendFrame(elements);
+    return Frame(std::move(block), 0);
+}
+
+std::string_view OutOfCoreTrajectory::frameText(int index) const
+{
+    const auto begin = _frameOffsets[index];
+    const auto end   = static_cast<size_t>(index + 1) < _frameOffsets.size() ?
+                           _frameOffsets[index + 1] :
+                           _indexedEnd;
+    return _data.substr(begin, end - begin);
+}
+
+int OutOfCoreTrajectory::completeFrameCount() const
+{
+    // The last frame indexed may still grow until the index is complete
+    if(_indexComplete || _frameOffsets.empty()) {
+        return static_cast<int>(_frameOffsets.size());
+    }
+    return static_cast<int>(_frameOffsets.size() - 1);
+}
+
+void OutOfCoreTrajectory::prefetch()
+{
+    // Most of the window lies ahead of the cursor in replay direction
+    const int ahead  = static_cast<int>(_windowSize * 3 / 4);
+    const int behind = static_cast<int>(_windowSize) - ahead;
+    std::unique_lock lock(_mutex);
+    while(true) {
+        _cursorChanged.wait(lock, [this]() { return _stop || _cursorMoved; });
+        if(_stop) {
+            return;
+        }
+        _cursorMoved    = false;
+        const int step  = _direction;
+        const int first = step > 0 ? _cursor - behind * step : _cursor + ahead * step;
+        const int last  = step > 0 ? _cursor + ahead * step : _cursor - behind * step;
+        for(auto iter = _window.begin(); iter != _window.end();) {
+            if(iter->first < first || iter->first > last) {
+                iter = _window.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+
+        // Decode ahead until the window is filled, restart as soon as the cursor moves
+        for(int k = 0; k < ahead && !_cursorMoved && !_stop; ++k) {
+            const int index = _cursor + k * step;
+            if(index < 0 || index >= completeFrameCount()) {
+                break;
+            }
+            if(_window.count(index) > 0) {
+                continue;
+            }
+            const auto text = frameText(index);
+            lock.unlock();
+            auto decoded = decode(text);
+            lock.lock();
+            _window.emplace(index, std::move(decoded));
+        }
+    }
+}
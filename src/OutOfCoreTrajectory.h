@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Frame.h"
+#include "TxtParsing.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/// Provides the frames of a trajectory txt file without decoding the whole file.
+/// buildIndex() scans the file once and records the byte offset of the first line of every frame.
+/// Frames are decoded on demand from the (memory mapped) text. Only a window of decoded frames
+/// around the frame cursor is kept, a background thread decodes the frames ahead of the cursor in
+/// the current replay direction and evicts frames that left the window.
+/// The file needs to be ordered by frame, as written by jpscore.
+class OutOfCoreTrajectory
+{
+    std::shared_ptr<const void> _mapping;
+    std::string_view _data;
+    Parsing::TxtLayout _layout;
+    size_t _windowSize;
+
+    mutable std::mutex _mutex{};
+    std::condition_variable _cursorChanged{};
+    /// Byte offsets of the first line of each frame in '_data'
+    std::vector<uint64_t> _frameOffsets{};
+    /// Byte offset up to which '_data' has been indexed
+    uint64_t _indexedEnd{0};
+    bool _indexComplete{false};
+    std::map<int, Frame> _window{};
+    int _cursor{0};
+    int _direction{1};
+    bool _cursorMoved{false};
+    bool _stop{false};
+    std::thread _prefetcher{};
+
+public:
+    /// Constructor
+    /// @param mapping keeps the memory of 'data' alive
+    /// @param data section of a trajectory txt file, i.e. without the header
+    /// @param layout of the data lines as declared in the header, see Parsing::TxtHeader::layout
+    /// @param windowSize number of decoded frames kept around the cursor
+    OutOfCoreTrajectory(
+        std::shared_ptr<const void> mapping,
+        std::string_view data,
+        Parsing::TxtLayout layout = {},
+        size_t windowSize         = 256);
+
+    OutOfCoreTrajectory(const OutOfCoreTrajectory &) = delete;
+    OutOfCoreTrajectory & operator=(const OutOfCoreTrajectory &) = delete;
+
+    /// Stops the prefetch thread
+    ~OutOfCoreTrajectory();
+
+    /// Scans the data and records where each frame starts. Frames become available while the
+    /// scan is running. Call this once, usually from a background thread.
+    /// @param cancel stops the scan if set
+    /// @param progress called repeatedly with the fraction of the data scanned so far
+    /// @return false if the data is not ordered by frame or the scan was cancelled
+    bool buildIndex(const std::atomic<bool> & cancel, const std::function<void(double)> & progress);
+
+    /// @return number of frames indexed so far
+    int frameCount() const;
+
+    /// Access a frame, frames outside the window are decoded on the calling thread.
+    /// @param index of the frame
+    /// @return the frame at 'index', an empty frame without block if 'index' is not less than
+    /// frameCount()
+    Frame frame(int index);
+
+    /// Moves the window, frames ahead of 'cursor' in 'direction' are decoded in the background.
+    /// @param cursor index of the frame currently displayed
+    /// @param direction frames advanced per replay step, negative for backwards replay, 0 keeps
+    /// the previous direction
+    void setCursor(int cursor, int direction);
+
+    /// @return bytes used by the index and the decoded frames
+    size_t memoryUsage() const;
+
+private:
+    /// @param text lines of a single frame
+    /// @return the frame decoded from 'text'
+    Frame decode(std::string_view text) const;
+
+    /// @return lines of frame 'index' in '_data', '_mutex' needs to be held
+    std::string_view frameText(int index) const;
+
+    /// @return number of complete frames, '_mutex' needs to be held
+    int completeFrameCount() const;
+
+    void prefetch();
+};
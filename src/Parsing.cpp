@@ -29,9 +29,13 @@
 #include "Parsing.h"
 
 #include "Frame.h"
+#include "FrameBlock.h"
 #include "FrameElement.h"
 #include "Log.h"
+#include "TrajectoryCache.h"
 #include "TrajectoryPoint.h"
+#include "TxtParsing.h"
+#include "TxtStreamParser.h"
 #include "geometry/Building.h"
 #include "geometry/FacilityGeometry.h"
 #include "geometry/GeometryFactory.h"
@@ -49,6 +53,7 @@
 #include <QPushButton>
 #include <QString>
 #include <QTextStream>
+#include <algorithm>
 #include <cstdio>
 #include <fstream>
 #include <glm/vec3.hpp>
@@ -56,6 +61,8 @@
 #include <limits>
 #include <memory>
 #include <optional>
+#include <string_view>
+#include <vector>
 #include <vtkActor.h>
 #include <vtkAssembly.h>
 #include <vtkCellArray.h>
@@ -123,6 +130,9 @@ InputFileType detectFileType(const std::filesystem::path & path)
         return InputFileType::GEOMETRY_XML;
     }
     if(file_extension == ".txt" || file_extension == ".TXT") {
+        if(hasValidTrajectoryCache(path)) {
+            return InputFileType::TRAJECTORIES_TXT_CACHED;
+        }
         return InputFileType::TRAJECTORIES_TXT;
     }
     return InputFileType::UNRECOGNIZED;
@@ -417,7 +427,47 @@ bool readJpsGeometryXml(const std::filesystem::path & path, GeometryFactory & ge
     return true;
 }
 
-bool ParseTxtFormat(const QString & fileName, TrajectoryData * trajectories)
+bool ParseTxtFormat(
+    const QString & fileName,
+    TrajectoryData * trajectories,
+    unsigned int numThreads)
+{
+    Log::Info("parsing txt trajectory <%s> ", fileName.toStdString().c_str());
+    QFile inputFile(fileName);
+    if(!inputFile.open(QIODevice::ReadOnly)) {
+        Log::Error("could not open the file  <%s>", fileName.toStdString().c_str());
+        return false;
+    }
+    const auto fileSize = inputFile.size();
+    if(fileSize == 0) {
+        return true;
+    }
+    const uchar * mapped = inputFile.map(0, fileSize);
+    if(mapped == nullptr) {
+        Log::Warning(
+            "could not memory map <%s>, falling back to stream parsing",
+            fileName.toStdString().c_str());
+        inputFile.close();
+        return ParseTxtFormatTextStream(fileName, trajectories);
+    }
+    const std::string_view data(reinterpret_cast<const char *>(mapped), fileSize);
+
+    const auto header = parseTxtHeader(data);
+    if(header.fps) {
+        Log::Info("Frame rate  <%.0f>", header.fps.value());
+        trajectories->setFps(header.fps.value());
+    }
+
+    TxtStreamParser parser(trajectories, numThreads, header.lineCount, header.layout);
+    parser.feed(data.substr(header.dataOffset));
+    parser.finish();
+
+    inputFile.unmap(const_cast<uchar *>(mapped));
+    inputFile.close();
+    return true;
+}
+
+bool ParseTxtFormatTextStream(const QString & fileName, TrajectoryData * trajectories)
 {
     Log::Info("parsing txt trajectory <%s> ", fileName.toStdString().c_str());
     QFile inputFile(fileName);
@@ -433,7 +483,7 @@ bool ParseTxtFormat(const QString & fileName, TrajectoryData * trajectories)
     const double unitFactor = FAKTOR;
     const QString sep("\t");
     bool headerRead = false;
-    std::map<size_t, std::unique_ptr<Frame>> frames{};
+    std::map<size_t, std::vector<FrameElement>> frames{};
     unsigned int lineCount{0};
     while(!in.atEnd()) {
         line = in.readLine();
@@ -485,18 +535,14 @@ bool ParseTxtFormat(const QString & fileName, TrajectoryData * trajectories)
             continue;
         }
 
-        auto element = FrameElement{pos, radius, angle, color, agentID - 1};
-        auto iter    = frames.find(frameID);
-        if(iter == frames.end()) {
-            auto [new_element, _] = frames.insert({frameID, std::make_unique<Frame>()});
-            iter                  = new_element;
-        }
-        iter->second->InsertElement(std::move(element));
+        frames[frameID].push_back(FrameElement{pos, radius, angle, color, agentID - 1});
     }
 
+    auto block = std::make_shared<FrameBlock>();
     for(auto && [k, v] : frames) {
-        trajectories->append(std::move(v));
+        block->appendFrame(v);
     }
+    trajectories->append(std::move(block));
 
     inputFile.close();
     return true;
@@ -49,6 +49,9 @@ enum class InputFileType {
     GEOMETRY_XML,
     /// This is trajectory data in TXT format created by jpscore
     TRAJECTORIES_TXT,
+    /// This is trajectory data in TXT format with a valid binary cache next to it, see
+    /// TrajectoryCache.h
+    TRAJECTORIES_TXT_CACHED,
     /// This is dummy type indicating that the file format is not recognised.
     UNRECOGNIZED
 };
@@ -72,7 +75,22 @@ InputFileType detectFileType(const std::filesystem::path & path);
 bool readJpsGeometryXml(const std::filesystem::path & path, GeometryFactory & geo);
 
 /// parse the txt file format
-bool ParseTxtFormat(const QString & fileName, TrajectoryData * trajectories);
+/// The file is memory mapped and tokenized in place, see TxtParsing.h. The data section is split
+/// into line aligned chunks that are parsed concurrently, the result does not depend on the number
+/// of threads used.
+/// @param fileName of the trajectory txt file
+/// @param trajectories receives the parsed frames
+/// @param numThreads to use for parsing, 0 uses one thread per hardware thread
+/// @return true on success
+bool ParseTxtFormat(
+    const QString & fileName,
+    TrajectoryData * trajectories,
+    unsigned int numThreads = 0);
+
+/// parse the txt file format line by line with a QTextStream
+/// This is the previous implementation of ParseTxtFormat. It is used as fallback if the file
+/// cannot be memory mapped and serves as baseline in the benchmarks.
+bool ParseTxtFormatTextStream(const QString & fileName, TrajectoryData * trajectories);
 
 /// Trains
 bool LoadTrainTimetable(
@@ -0,0 +1,89 @@
+#include "PlaybackClock.h"
+
+#include <algorithm>
+
+namespace
+{
+/// Rendering may take this much longer than measured before the display interval is exceeded
+constexpr double renderHeadroom = 1.25;
+/// Weight of a new measurement in the smoothed render cost
+constexpr double renderCostWeight = 0.2;
+} // namespace
+
+void PlaybackClock::SetFps(double fps)
+{
+    _fps = fps;
+}
+
+void PlaybackClock::SetSpeed(double speed)
+{
+    _speed = speed;
+}
+
+void PlaybackClock::SetFixedStep(bool fixedStep)
+{
+    _fixedStep = fixedStep;
+}
+
+void PlaybackClock::Start(double position, Clock::time_point now)
+{
+    _position         = position;
+    _lastPresentation = now;
+    _running          = true;
+}
+
+void PlaybackClock::Stop()
+{
+    _running = false;
+}
+
+bool PlaybackClock::IsRunning() const
+{
+    return _running;
+}
+
+void PlaybackClock::Seek(double position)
+{
+    _position = position;
+}
+
+bool PlaybackClock::Tick(Clock::time_point now, int lastFrame)
+{
+    if(!_running) {
+        return false;
+    }
+    // ticks arrive at MAX_DISPLAY_RATE with some jitter, accept them up to half a tick early
+    const double elapsed = std::chrono::duration<double>(now - _lastPresentation).count();
+    if(elapsed + 0.5 / MAX_DISPLAY_RATE < DisplayInterval()) {
+        return false;
+    }
+    _lastPresentation    = now;
+    const double last    = std::max(lastFrame, 0);
+    const double advance = _fixedStep ? _speed : elapsed * _fps * _speed;
+    _position            = std::clamp(_position + advance, 0.0, last);
+    return true;
+}
+
+double PlaybackClock::Position() const
+{
+    return _position;
+}
+
+void PlaybackClock::RenderFinished(Clock::duration cost)
+{
+    const double seconds = std::chrono::duration<double>(cost).count();
+    _renderCost          = _renderCost == 0 ?
+                               seconds :
+                               (1 - renderCostWeight) * _renderCost + renderCostWeight * seconds;
+}
+
+double PlaybackClock::DisplayInterval() const
+{
+    return std::clamp(
+        _renderCost * renderHeadroom, 1.0 / MAX_DISPLAY_RATE, 1.0 / MIN_DISPLAY_RATE);
+}
+
+double PlaybackClock::ExpectedAdvance() const
+{
+    return _fixedStep ? _speed : DisplayInterval() * _fps * _speed;
+}
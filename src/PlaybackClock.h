@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+
+/// Wall clock driving the replay.
+/// The replay position advances by the time that passed since the last presented frame, scaled
+/// by the recording fps and the replay speed. It does not depend on how often the scene is
+/// rendered: if rendering falls behind, the position advances by several frames at once and the
+/// frames in between are skipped, so the replayed time stays in sync with the wall clock.
+/// The position is fractional, it lies between two recorded frames most of the time.
+/// The clock also measures how long rendering takes and derives the display interval from it.
+/// Frames are presented as often as the renderer keeps up, within [MIN_DISPLAY_RATE,
+/// MAX_DISPLAY_RATE].
+/// While a video is recorded, the position advances by a fixed step per presented frame instead,
+/// see SetFixedStep().
+class PlaybackClock
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Upper bound of presented frames per second, Tick() should be called at this rate
+    static constexpr double MAX_DISPLAY_RATE = 60;
+    /// Lower bound of presented frames per second, as long as rendering is fast enough
+    static constexpr double MIN_DISPLAY_RATE = 10;
+
+private:
+    double _fps{0};
+    double _speed{1};
+    /// Replay position in frames
+    double _position{0};
+    bool _running{false};
+    bool _fixedStep{false};
+    Clock::time_point _lastPresentation{};
+    /// Smoothed time needed to render a frame in seconds
+    double _renderCost{0};
+
+public:
+    PlaybackClock()  = default;
+    ~PlaybackClock() = default;
+
+    /// @param fps the trajectory was recorded with
+    void SetFps(double fps);
+
+    /// @param speed replayed seconds per second, negative values replay backwards
+    void SetSpeed(double speed);
+
+    /// Selects how the position advances. With a fixed step every presented frame advances the
+    /// position by the replay speed in frames, regardless of the time passed. A video encoded at
+    /// the recording fps with one frame per presented frame then plays at the replay speed.
+    /// @param fixedStep true to advance by a fixed step, false to follow the wall clock
+    void SetFixedStep(bool fixedStep);
+
+    /// Starts advancing the position
+    /// @param position to start from in frames
+    /// @param now current time
+    void Start(double position, Clock::time_point now);
+
+    /// Stops advancing the position
+    void Stop();
+
+    /// @return true if the position is advancing
+    bool IsRunning() const;
+
+    /// Moves the position, e.g. if the user selected a frame while replaying
+    /// @param position in frames
+    void Seek(double position);
+
+    /// Advances the position if the display interval has passed since the last presented frame
+    /// @param now current time
+    /// @param lastFrame index of the last available frame, the position is clamped to it
+    /// @return true if a frame should be presented
+    bool Tick(Clock::time_point now, int lastFrame);
+
+    /// @return the replay position in frames
+    double Position() const;
+
+    /// Reports the time needed to render a presented frame
+    /// @param cost time spent rendering
+    void RenderFinished(Clock::duration cost);
+
+    /// @return time between two presented frames in seconds
+    double DisplayInterval() const;
+
+    /// @return frames the position is expected to advance by until the next presented frame,
+    /// negative when replaying backwards
+    double ExpectedAdvance() const;
+};
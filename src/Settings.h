@@ -2,6 +2,7 @@
 #include "RenderMode.h"
 
 #include <QColor>
+#include <QDir>
 #include <QString>
 
 struct Settings {
@@ -10,7 +11,10 @@ struct Settings {
     QColor floorColor{0, 0, 255};
     QColor wallsColor{180, 180, 180};
     QColor exitsColor{175, 175, 255};
+    /// Prepended to the names of screenshots, image sequences and videos
     QString filesPrefix{""};
+    /// Directory screenshots, image sequences and videos are written to
+    QString outputDirectory{QDir::homePath() + "/Desktop/JPSvis_Files"};
     bool showAgentsCaptions{false};
     bool showAgentDirections{false};
     bool showAgents{true};
@@ -21,6 +25,20 @@ struct Settings {
     bool showWalls{true};
     bool showExits{true};
     bool showTrajectories{false};
+    /// Time span in seconds covered by the agent trails
+    double trailDuration{10};
     bool showInfos{true};
     bool recordPNGsequence{false};
+    /// Load trajectories out-of-core, i.e. decode frames on demand instead of loading all
+    bool outOfCore{false};
+    /// Follow trajectory files that are still being written
+    bool followFile{false};
+    /// Move to the newest frame whenever frames are appended to a followed file
+    bool pinToNewestFrame{false};
+    /// Draw agents with GPU instancing instead of copying the glyph geometry per agent on the CPU
+    bool instancedAgents{true};
+    /// Interpolate the agents between recorded frames during the replay
+    bool interpolateFrames{true};
+    /// Draw agents with less detail if they are small on screen or very many
+    bool levelOfDetail{true};
 };
@@ -0,0 +1,131 @@
+#include "TemporalPyramid.h"
+
+#include <algorithm>
+#include <cmath>
+
+double TemporalPyramid::Summary::meanAgents() const
+{
+    return frameCount == 0 ? 0 : static_cast<double>(totalAgents) / frameCount;
+}
+
+double TemporalPyramid::Summary::meanColor() const
+{
+    return coloredAgents == 0 ? NAN : totalColor / static_cast<double>(coloredAgents);
+}
+
+bool TemporalPyramid::Summary::isEmpty() const
+{
+    return totalAgents == 0;
+}
+
+void TemporalPyramid::Summary::merge(const Summary & other)
+{
+    if(other.frameCount == 0) {
+        return;
+    }
+    if(frameCount == 0) {
+        *this = other;
+        return;
+    }
+    if(isEmpty()) {
+        minX = other.minX;
+        minY = other.minY;
+        maxX = other.maxX;
+        maxY = other.maxY;
+    } else if(!other.isEmpty()) {
+        minX = std::min(minX, other.minX);
+        minY = std::min(minY, other.minY);
+        maxX = std::max(maxX, other.maxX);
+        maxY = std::max(maxY, other.maxY);
+    }
+    frameCount += other.frameCount;
+    minAgents = std::min(minAgents, other.minAgents);
+    maxAgents = std::max(maxAgents, other.maxAgents);
+    totalAgents += other.totalAgents;
+    coloredAgents += other.coloredAgents;
+    totalColor += other.totalColor;
+}
+
+void TemporalPyramid::append(const FrameBlock::FrameStats & stats)
+{
+    Summary summary{};
+    summary.frameCount    = 1;
+    summary.minAgents     = stats.agents;
+    summary.maxAgents     = stats.agents;
+    summary.totalAgents   = stats.agents;
+    summary.coloredAgents = stats.coloredAgents;
+    summary.totalColor    = stats.colorSum;
+    summary.minX          = stats.minX;
+    summary.minY          = stats.minY;
+    summary.maxX          = stats.maxX;
+    summary.maxY          = stats.maxY;
+
+    if(_levels.empty()) {
+        _levels.emplace_back();
+    }
+    const size_t index = _levels[0].size();
+    _levels[0].push_back(summary);
+    // node index >> k of level k covers the new frame, a new node is started every 2^k frames
+    for(size_t k = 1; k < _levels.size() || (index >> (k - 1)) > 0; ++k) {
+        if(k == _levels.size()) {
+            // the new level starts with the summary of all frames so far
+            _levels.emplace_back(1, _levels[k - 1][0]);
+            _levels[k][0].merge(_levels[k - 1][1]);
+            continue;
+        }
+        auto & nodes      = _levels[k];
+        const size_t node = index >> k;
+        if(node == nodes.size()) {
+            nodes.push_back(summary);
+        } else {
+            nodes[node].merge(summary);
+        }
+    }
+}
+
+void TemporalPyramid::clear()
+{
+    _levels.clear();
+}
+
+int TemporalPyramid::levelCount() const
+{
+    return static_cast<int>(_levels.size());
+}
+
+const std::vector<TemporalPyramid::Summary> & TemporalPyramid::level(int level) const
+{
+    return _levels[level];
+}
+
+size_t TemporalPyramid::memoryUsage() const
+{
+    size_t bytes = _levels.capacity() * sizeof(std::vector<Summary>);
+    for(const auto & nodes : _levels) {
+        bytes += nodes.capacity() * sizeof(Summary);
+    }
+    return bytes;
+}
+
+int TemporalPyramid::levelForStride(double stride)
+{
+    if(!(stride >= 2)) {
+        return 0;
+    }
+    return std::min(static_cast<int>(std::floor(std::log2(stride))), 30);
+}
+
+int TemporalPyramid::levelForNodeCount(size_t frameCount, size_t maxNodes)
+{
+    int level{0};
+    maxNodes = std::max<size_t>(maxNodes, 1);
+    while(((frameCount + (size_t{1} << level) - 1) >> level) > maxNodes) {
+        ++level;
+    }
+    return level;
+}
+
+int TemporalPyramid::snapToLevel(int frame, int level)
+{
+    return (frame >> level) << level;
+}
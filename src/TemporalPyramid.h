@@ -0,0 +1,88 @@
+#pragma once
+
+#include "FrameBlock.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Summaries of the frames of a trajectory at several temporal resolutions, built from the
+/// statistics gathered while the frames are parsed (see FrameBlock::FrameStats).
+/// Level k consists of the frames whose index is a multiple of 2^k. Its node i summarizes the 2^k
+/// frames [i * 2^k, (i + 1) * 2^k), level 0 holds one node per frame. Views that can not show
+/// every frame, e.g. the frame slider of a run with a million frames or the replay at a high
+/// speed, read the coarsest level that is still fine enough and only touch the frames of that
+/// level. The exact frames stay available, the pyramid only adds about two summaries per frame.
+class TemporalPyramid
+{
+public:
+    /// Summary of consecutive frames
+    struct Summary {
+        /// Number of frames summarized, 2^k except for the last node of level k
+        uint32_t frameCount{0};
+        /// Least number of agents in a frame
+        uint32_t minAgents{0};
+        /// Largest number of agents in a frame
+        uint32_t maxAgents{0};
+        /// Sum of the number of agents over all frames
+        uint64_t totalAgents{0};
+        /// Sum of the number of agents with a color over all frames
+        uint64_t coloredAgents{0};
+        /// Sum of the colors of all agents with a color
+        double totalColor{0};
+        /// Bounding box of all agents in the x-y plane in cm, empty if there are none
+        float minX{0};
+        float minY{0};
+        float maxX{0};
+        float maxY{0};
+
+        /// @return mean number of agents per frame
+        double meanAgents() const;
+
+        /// @return mean color of the agents with a color, i.e. their mean speed relative to their
+        /// desired speed times 255 for trajectories written by jpscore, NaN if there is none
+        double meanColor() const;
+
+        /// @return true if no agent is summarized
+        bool isEmpty() const;
+
+        /// Adds the frames summarized by 'other'
+        void merge(const Summary & other);
+    };
+
+private:
+    /// Nodes of each level, level 0 first
+    std::vector<std::vector<Summary>> _levels{};
+
+public:
+    /// Summarizes the next frame
+    /// @param stats of the frame appended after all frames added so far
+    void append(const FrameBlock::FrameStats & stats);
+
+    /// Removes all summaries
+    void clear();
+
+    /// @return number of levels, 0 without frames
+    int levelCount() const;
+
+    /// @param level in [0, levelCount())
+    /// @return the nodes of 'level'
+    const std::vector<Summary> & level(int level) const;
+
+    /// @return bytes used by the summaries
+    size_t memoryUsage() const;
+
+    /// @param stride number of frames at least between the frames needed
+    /// @return the coarsest level whose frames are at most 'stride' frames apart
+    static int levelForStride(double stride);
+
+    /// @param frameCount number of frames summarized
+    /// @param maxNodes number of nodes needed at most
+    /// @return the finest level with at most 'maxNodes' nodes
+    static int levelForNodeCount(size_t frameCount, size_t maxNodes);
+
+    /// @param frame index of a frame
+    /// @param level of the pyramid
+    /// @return index of the frame of 'level' at or before 'frame'
+    static int snapToLevel(int frame, int level);
+};
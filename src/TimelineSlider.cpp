@@ -0,0 +1,129 @@
+#include "TimelineSlider.h"
+
+#include <QColor>
+#include <QEvent>
+#include <QHelpEvent>
+#include <QPainter>
+#include <QPainterPath>
+#include <QStyle>
+#include <QStyleOptionSlider>
+#include <QToolTip>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+const QColor agentsColor{70, 130, 180, 90};
+const QColor speedColor{230, 120, 20, 200};
+/// Color of agents walking at their desired speed, see FrameBlock::FrameStats::colorSum
+constexpr double freeFlowColor = 255;
+} // namespace
+
+TimelineSlider::TimelineSlider(QWidget * parent) : QSlider(parent) {}
+
+void TimelineSlider::setSummaries(std::vector<TemporalPyramid::Summary> && summaries, int level)
+{
+    _summaries = std::move(summaries);
+    _level     = level;
+    _maxAgents = 0;
+    for(const auto & summary : _summaries) {
+        _maxAgents = std::max(_maxAgents, summary.maxAgents);
+    }
+    update();
+}
+
+void TimelineSlider::paintEvent(QPaintEvent * event)
+{
+    if(!_summaries.empty() && _maxAgents > 0 && orientation() == Qt::Horizontal) {
+        QPainter painter(this);
+        const QRect area    = rect().adjusted(0, 1, 0, -1);
+        const double scale  = area.height() / static_cast<double>(_maxAgents);
+        const double bottom = area.bottom();
+        QPainterPath speed;
+        bool speedStarted{false};
+
+        // a bar of the largest number of agents in the frames of each column
+        painter.setPen(agentsColor);
+        for(int x = area.left(); x <= area.right(); ++x) {
+            const auto summary = summaryAt(x);
+            if(summary.frameCount == 0) {
+                continue;
+            }
+            painter.drawLine(QPointF(x, bottom), QPointF(x, bottom - summary.maxAgents * scale));
+            const double color = summary.meanColor();
+            if(std::isnan(color)) {
+                continue;
+            }
+            const QPointF point(x, bottom - std::min(color / freeFlowColor, 1.0) * area.height());
+            if(speedStarted) {
+                speed.lineTo(point);
+            } else {
+                speed.moveTo(point);
+                speedStarted = true;
+            }
+        }
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(QPen(speedColor, 1.5));
+        painter.drawPath(speed);
+    }
+    // groove and handle on top
+    QSlider::paintEvent(event);
+}
+
+bool TimelineSlider::event(QEvent * event)
+{
+    if(event->type() != QEvent::ToolTip || _summaries.empty()) {
+        return QSlider::event(event);
+    }
+    auto * helpEvent   = static_cast<QHelpEvent *>(event);
+    const auto summary = summaryAt(helpEvent->pos().x());
+    if(summary.frameCount == 0) {
+        QToolTip::hideText();
+        event->ignore();
+        return true;
+    }
+    const int first = TemporalPyramid::snapToLevel(frameAt(helpEvent->pos().x()), _level);
+    QString text    = QString("Frames %1 - %2\nAgents: %3 - %4 (mean %5)")
+                       .arg(first)
+                       .arg(first + static_cast<int>(summary.frameCount) - 1)
+                       .arg(summary.minAgents)
+                       .arg(summary.maxAgents)
+                       .arg(summary.meanAgents(), 0, 'f', 1);
+    const double color = summary.meanColor();
+    if(!std::isnan(color)) {
+        text += QString("\nMean speed: %1 % of the desired speed")
+                    .arg(100 * color / freeFlowColor, 0, 'f', 0);
+    }
+    QToolTip::showText(helpEvent->globalPos(), text, this);
+    return true;
+}
+
+TemporalPyramid::Summary TimelineSlider::summaryAt(int x) const
+{
+    const int nodeCount = static_cast<int>(_summaries.size());
+    // the frames reached by dragging the handle to this column up to the next one
+    int end = frameAt(x + 1);
+    if(end >= maximum()) {
+        end = maximum() + 1;
+    }
+    const int first = frameAt(x) >> _level;
+    const int last  = std::min(std::max(first, (end - 1) >> _level), nodeCount - 1);
+    TemporalPyramid::Summary summary{};
+    for(int node = std::max(first, 0); node <= last; ++node) {
+        summary.merge(_summaries[node]);
+    }
+    return summary;
+}
+
+int TimelineSlider::frameAt(int x) const
+{
+    QStyleOptionSlider option;
+    initStyleOption(&option);
+    const QRect groove =
+        style()->subControlRect(QStyle::CC_Slider, &option, QStyle::SC_SliderGroove, this);
+    const QRect handle =
+        style()->subControlRect(QStyle::CC_Slider, &option, QStyle::SC_SliderHandle, this);
+    const int span = groove.width() - handle.width();
+    const int pos  = std::clamp(x - groove.x() - handle.width() / 2, 0, std::max(span, 0));
+    return QStyle::sliderValueFromPosition(minimum(), maximum(), pos, span, option.upsideDown);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "TemporalPyramid.h"
+
+#include <QSlider>
+#include <vector>
+
+/// Frame slider drawing a sparkline of the number of agents and their mean speed behind the
+/// handle. The sparkline is drawn from a level of the temporal pyramid (see TemporalPyramid), so
+/// it costs a few hundred summaries regardless of the length of the run. Hovering the slider shows
+/// the statistics of the frames under the cursor without seeking there.
+class TimelineSlider : public QSlider
+{
+    Q_OBJECT
+
+    std::vector<TemporalPyramid::Summary> _summaries{};
+    int _level{0};
+    uint32_t _maxAgents{0};
+
+public:
+    explicit TimelineSlider(QWidget * parent = nullptr);
+    ~TimelineSlider() override = default;
+
+    /// Sets the statistics to draw
+    /// @param summaries nodes of a level of the temporal pyramid, empty to draw no sparkline
+    /// @param level of the nodes, node i summarizes the frames [i * 2^level, (i + 1) * 2^level)
+    void setSummaries(std::vector<TemporalPyramid::Summary> && summaries, int level);
+
+protected:
+    void paintEvent(QPaintEvent * event) override;
+    bool event(QEvent * event) override;
+
+private:
+    /// @param x position in the widget
+    /// @return summary of the frames covered by the pixel column at 'x'
+    TemporalPyramid::Summary summaryAt(int x) const;
+
+    /// @param x position in the widget
+    /// @return index of the frame at 'x', as if the handle was dragged there
+    int frameAt(int x) const;
+};
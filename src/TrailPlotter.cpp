@@ -1,51 +1,111 @@
 #include "TrailPlotter.h"
 
-#include "general/Macros.h"
+#include "Frame.h"
+#include "TrajectoryData.h"
 
+#include <algorithm>
+#include <cmath>
 #include <vtkActor.h>
-#include <vtkAppendPolyData.h>
-#include <vtkCleanPolyData.h>
-#include <vtkDiskSource.h>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkLookupTable.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
-#include <vtkSmartPointer.h>
-#include <vtkStripper.h>
-#include <vtkTriangleFilter.h>
+#include <vtkProperty.h>
 
-TrailPlotter::TrailPlotter()
+TrailPlotter::TrailPlotter() :
+    _points(vtkSmartPointer<vtkPoints>::New()),
+    _pointColors(vtkSmartPointer<vtkFloatArray>::New()),
+    _offsets(vtkSmartPointer<vtkIdTypeArray>::New()),
+    _connectivity(vtkSmartPointer<vtkIdTypeArray>::New()),
+    _lines(vtkSmartPointer<vtkCellArray>::New()),
+    _polyData(vtkSmartPointer<vtkPolyData>::New()),
+    _trailActor(vtkSmartPointer<vtkActor>::New())
 {
-    // trails sources
-    VTK_CREATE(vtkDiskSource, agentShape);
-    agentShape->SetCircumferentialResolution(20);
-    agentShape->SetInnerRadius(0);
-    agentShape->SetOuterRadius(30);
+    _points->SetDataTypeToFloat();
+    _pointColors->SetName("color");
+    _pointColors->SetNumberOfComponents(1);
 
-    // speed the rendering using triangles stripers
-    vtkTriangleFilter * tris = vtkTriangleFilter::New();
-    tris->SetInputConnection(agentShape->GetOutputPort());
+    _polyData->SetPoints(_points);
+    _polyData->SetLines(_lines);
+    _polyData->GetPointData()->SetScalars(_pointColors);
 
-    vtkStripper * strip = vtkStripper::New();
-    strip->SetInputConnection(tris->GetOutputPort());
+    // same colors as the agents
+    vtkNew<vtkLookupTable> lut;
+    lut->SetHueRange(0.0, 0.470);
+    lut->SetValueRange(1.0, 1.0);
+    lut->SetNanColor(0.2, 0.2, 0.2, 0.5);
+    lut->SetNumberOfTableValues(256);
+    lut->Build();
 
-    _appendFilter = vtkSmartPointer<vtkAppendPolyData>::New();
-    _appendFilter->SetInputConnection(strip->GetOutputPort());
+    vtkNew<vtkPolyDataMapper> mapper;
+    mapper->SetInputData(_polyData);
+    mapper->SetLookupTable(lut);
 
-    // Remove any duplicate points.
-    _cleanFilter = vtkSmartPointer<vtkCleanPolyData>::New();
-
-    // Create a mapper and actor
-    vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+    _trailActor->SetMapper(mapper);
+    _trailActor->GetProperty()->SetLineWidth(2);
+    updatePolyData();
+}
 
-    _trailActor = vtkSmartPointer<vtkActor>::New();
+void TrailPlotter::SetWindow(size_t frames)
+{
+    frames = std::max<size_t>(frames, 1);
+    if(frames == _window) {
+        return;
+    }
+    _window = frames;
+    Clear();
 }
 
-TrailPlotter::~TrailPlotter() {}
+void TrailPlotter::Update(const TrajectoryData & trajectories, int frameIndex)
+{
+    if(frameIndex == _lastFrame) {
+        return;
+    }
+    if(frameIndex < 0 || frameIndex >= trajectories.getFrameCount()) {
+        Clear();
+        return;
+    }
+
+    const int window = static_cast<int>(_window);
+    const int first  = std::max(0, frameIndex - window + 1);
+    if(_lastFrame >= 0 && frameIndex > _lastFrame && frameIndex - _lastFrame < window) {
+        // forwards: the newest frames enter the window, the oldest leave it
+        evict(first, frameIndex);
+        for(int index = _lastFrame + 1; index <= frameIndex; ++index) {
+            pushBack(trajectories.frameAt(index), index);
+        }
+    } else if(_lastFrame >= 0 && frameIndex < _lastFrame && _lastFrame - frameIndex < window) {
+        // backwards: the newest frames leave the window, older frames enter it again
+        evict(first, frameIndex);
+        const int lastFirst = std::max(0, _lastFrame - window + 1);
+        for(int index = lastFirst - 1; index >= first; --index) {
+            pushFront(trajectories.frameAt(index), index);
+        }
+    } else {
+        // seek: none of the current entries can be reused
+        Clear();
+        for(int index = first; index <= frameIndex; ++index) {
+            pushBack(trajectories.frameAt(index), index);
+        }
+    }
+    _lastFrame = frameIndex;
+    updatePolyData();
+}
 
-void TrailPlotter::AddDataSet(vtkPolyData * _polydata)
+void TrailPlotter::Clear()
 {
-    _appendFilter->AddInputData(_polydata);
-    _appendFilter->Update();
-    _cleanFilter->Update();
+    _trails.clear();
+    _trailOfAgent.clear();
+    _freeTrails.clear();
+    _frames.clear();
+    _positions.clear();
+    _colors.clear();
+    _lastFrame = -1;
+    updatePolyData();
 }
 
 vtkActor * TrailPlotter::getActor()
@@ -57,3 +117,132 @@ void TrailPlotter::SetVisibility(bool status)
 {
     _trailActor->SetVisibility(status);
 }
+
+void TrailPlotter::pushBack(const Frame & frame, int frameIndex)
+{
+    const auto columns = frame.Columns();
+    for(int i = 0; i < frame.Size(); ++i) {
+        const size_t index = trailOf(columns.id[i]);
+        auto & trail       = _trails[index];
+        if(trail.count == _window) {
+            // only possible if an agent shows up twice in a frame, replace the oldest entry
+            trail.first = (trail.first + 1) % _window;
+            --trail.count;
+        }
+        const size_t entry        = index * _window + (trail.first + trail.count) % _window;
+        _frames[entry]            = frameIndex;
+        _positions[3 * entry]     = columns.x[i];
+        _positions[3 * entry + 1] = columns.y[i];
+        _positions[3 * entry + 2] = columns.z[i];
+        _colors[entry]            = columns.color[i] == -1 ? NAN : columns.color[i] / 255.f;
+        ++trail.count;
+    }
+}
+
+void TrailPlotter::pushFront(const Frame & frame, int frameIndex)
+{
+    const auto columns = frame.Columns();
+    for(int i = 0; i < frame.Size(); ++i) {
+        const size_t index = trailOf(columns.id[i]);
+        auto & trail       = _trails[index];
+        if(trail.count == _window) {
+            continue;
+        }
+        trail.first               = (trail.first + _window - 1) % _window;
+        const size_t entry        = index * _window + trail.first;
+        _frames[entry]            = frameIndex;
+        _positions[3 * entry]     = columns.x[i];
+        _positions[3 * entry + 1] = columns.y[i];
+        _positions[3 * entry + 2] = columns.z[i];
+        _colors[entry]            = columns.color[i] == -1 ? NAN : columns.color[i] / 255.f;
+        ++trail.count;
+    }
+}
+
+void TrailPlotter::evict(int first, int last)
+{
+    for(auto iter = _trailOfAgent.begin(); iter != _trailOfAgent.end();) {
+        auto & trail      = _trails[iter->second];
+        const size_t base = iter->second * _window;
+        while(trail.count > 0 && _frames[base + trail.first] < first) {
+            trail.first = (trail.first + 1) % _window;
+            --trail.count;
+        }
+        while(trail.count > 0 &&
+              _frames[base + (trail.first + trail.count - 1) % _window] > last) {
+            --trail.count;
+        }
+        if(trail.count == 0) {
+            _freeTrails.push_back(iter->second);
+            iter = _trailOfAgent.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+size_t TrailPlotter::trailOf(int agentID)
+{
+    if(const auto iter = _trailOfAgent.find(agentID); iter != _trailOfAgent.end()) {
+        return iter->second;
+    }
+    size_t index{0};
+    if(_freeTrails.empty()) {
+        index = _trails.size();
+        _trails.emplace_back();
+        _frames.resize(_trails.size() * _window);
+        _positions.resize(3 * _trails.size() * _window);
+        _colors.resize(_trails.size() * _window);
+    } else {
+        index = _freeTrails.back();
+        _freeTrails.pop_back();
+    }
+    _trailOfAgent.emplace(agentID, index);
+    _trails[index] = Trail{};
+    return index;
+}
+
+void TrailPlotter::updatePolyData()
+{
+    // a trail needs two positions to be drawn
+    vtkIdType pointCount{0};
+    vtkIdType lineCount{0};
+    for(const auto & [agentID, index] : _trailOfAgent) {
+        if(_trails[index].count > 1) {
+            pointCount += static_cast<vtkIdType>(_trails[index].count);
+            ++lineCount;
+        }
+    }
+
+    _points->SetNumberOfPoints(pointCount);
+    auto * pointData         = static_cast<vtkFloatArray *>(_points->GetData());
+    float * points           = pointData->WritePointer(0, 3 * pointCount);
+    float * colors           = _pointColors->WritePointer(0, pointCount);
+    vtkIdType * offsets      = _offsets->WritePointer(0, lineCount + 1);
+    vtkIdType * connectivity = _connectivity->WritePointer(0, pointCount);
+
+    vtkIdType point{0};
+    vtkIdType line{0};
+    offsets[0] = 0;
+    for(const auto & [agentID, index] : _trailOfAgent) {
+        const auto & trail = _trails[index];
+        if(trail.count < 2) {
+            continue;
+        }
+        for(size_t k = 0; k < trail.count; ++k) {
+            const size_t entry    = index * _window + (trail.first + k) % _window;
+            points[3 * point]     = _positions[3 * entry];
+            points[3 * point + 1] = _positions[3 * entry + 1];
+            points[3 * point + 2] = _positions[3 * entry + 2];
+            colors[point]         = _colors[entry];
+            connectivity[point]   = point;
+            ++point;
+        }
+        offsets[++line] = point;
+    }
+    _lines->SetData(_offsets, _connectivity);
+
+    _points->Modified();
+    _pointColors->Modified();
+    _polyData->Modified();
+}
@@ -1,23 +1,75 @@
 #pragma once
 
-class vtkPolyData;
-class vtkActor;
-class vtkAppendPolyData;
-class vtkAppendPolyData;
-class vtkCleanPolyData;
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include <vtkSmartPointer.h>
 
+class Frame;
+class TrajectoryData;
+class vtkActor;
+class vtkCellArray;
+class vtkFloatArray;
+class vtkIdTypeArray;
+class vtkPoints;
+class vtkPolyData;
 
+/// Draws the recent path of every agent as one polyline.
+/// A trail covers the frames (current - window, current]. The positions of each agent are kept in
+/// a ring buffer with a capacity of 'window' entries, so the memory needed is bounded and
+/// independent of the replay time. Update() works out which frames entered and left the window
+/// since the last call: replaying forwards appends new positions and evicts the oldest ones,
+/// replaying backwards removes the newest positions and adds older ones again. Larger jumps, e.g.
+/// seeking, rebuild the trails from the frames in the window.
 class TrailPlotter
 {
+    /// Ring buffer of an agent, the entries are [first, first + count) modulo the capacity
+    struct Trail {
+        size_t first{0};
+        size_t count{0};
+    };
+
+    size_t _window{1};
+    /// Frame the trails have been updated to, -1 if there are none
+    int _lastFrame{-1};
+
+    std::vector<Trail> _trails{};
+    /// Index of the trail in '_trails' per agent id
+    std::unordered_map<int, size_t> _trailOfAgent{};
+    /// Trails no longer in use
+    std::vector<size_t> _freeTrails{};
+    /// Ring buffer storage, '_window' entries per trail
+    std::vector<int> _frames{};
+    std::vector<float> _positions{};
+    std::vector<float> _colors{};
+
+    vtkSmartPointer<vtkPoints> _points;
+    vtkSmartPointer<vtkFloatArray> _pointColors;
+    vtkSmartPointer<vtkIdTypeArray> _offsets;
+    vtkSmartPointer<vtkIdTypeArray> _connectivity;
+    vtkSmartPointer<vtkCellArray> _lines;
+    vtkSmartPointer<vtkPolyData> _polyData;
+    vtkSmartPointer<vtkActor> _trailActor;
+
 public:
-    /// constructor
     TrailPlotter();
+    ~TrailPlotter() = default;
+
+    TrailPlotter(const TrailPlotter &) = delete;
+    TrailPlotter & operator=(const TrailPlotter &) = delete;
 
-    /// destructor
-    virtual ~TrailPlotter();
+    /// Sets the number of frames covered by a trail, the trails are rebuilt with the next update if
+    /// it changes.
+    /// @param frames covered by a trail, at least 1
+    void SetWindow(size_t frames);
 
-    /// add a dataset to plot
-    void AddDataSet(vtkPolyData * _polydata);
+    /// Brings the trails to 'frameIndex'
+    /// @param trajectories to read the frames entering the window from
+    /// @param frameIndex index of the current frame
+    void Update(const TrajectoryData & trajectories, int frameIndex);
+
+    /// Removes all trails
+    void Clear();
 
     /// return the actor responsible for the plotting
     vtkActor * getActor();
@@ -26,9 +78,18 @@ public:
     void SetVisibility(bool status);
 
 private:
-    vtkActor * _trailActor;
-    // combine polydatas sets
-    vtkAppendPolyData * _appendFilter;
-    // Remove any duplicate points.
-    vtkCleanPolyData * _cleanFilter;
+    /// Adds the positions of 'frame' as newest entries
+    void pushBack(const Frame & frame, int frameIndex);
+
+    /// Adds the positions of 'frame' as oldest entries
+    void pushFront(const Frame & frame, int frameIndex);
+
+    /// Removes all entries outside of [first, last] and releases empty trails
+    void evict(int first, int last);
+
+    /// @return index of the trail of 'agentID', a new one is created if there is none
+    size_t trailOf(int agentID);
+
+    /// Writes the trails into the polydata
+    void updatePolyData();
 };
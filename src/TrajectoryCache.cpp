@@ -0,0 +1,302 @@
+#include "TrajectoryCache.h"
+
+#include "Frame.h"
+#include "FrameBlock.h"
+#include "Log.h"
+#include "TrajectoryData.h"
+
+#include <QFile>
+#include <QString>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+constexpr std::array<char, 8> cacheMagic{'J', 'P', 'S', 'V', 'I', 'S', 'C', '\0'};
+constexpr uint32_t cacheVersion = 2;
+/// Written as is, a cache created on a machine with different byte order does not match
+constexpr uint32_t byteOrderMark = 0x01020304;
+
+struct CacheHeader {
+    std::array<char, 8> magic{cacheMagic};
+    uint32_t version{cacheVersion};
+    uint32_t byteOrder{byteOrderMark};
+    uint64_t sourceSize{0};
+    int64_t sourceModificationTime{0};
+    uint64_t sourceHash{0};
+    double fps{0};
+    uint64_t frameCount{0};
+    uint64_t elementCount{0};
+};
+static_assert(sizeof(CacheHeader) == 64, "CacheHeader is expected to have no padding");
+static_assert(
+    sizeof(FrameBlock::FrameStats) == 32,
+    "FrameBlock::FrameStats is expected to have no padding");
+
+constexpr size_t numFloatColumns = 7;
+/// Float columns in the order they are stored in the cache
+constexpr std::array<const float * FrameBlock::Columns::*, numFloatColumns> floatColumns{
+    &FrameBlock::Columns::x,
+    &FrameBlock::Columns::y,
+    &FrameBlock::Columns::z,
+    &FrameBlock::Columns::radiusA,
+    &FrameBlock::Columns::radiusB,
+    &FrameBlock::Columns::angle,
+    &FrameBlock::Columns::color};
+
+/// Size and modification time of the txt file together with a hash of its content.
+struct SourceKey {
+    uint64_t size{0};
+    int64_t modificationTime{0};
+    uint64_t hash{0};
+};
+
+void fnv1a(uint64_t & hash, const char * data, size_t size)
+{
+    for(size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+}
+
+/// Hashing a file of several GB would take about as long as parsing it. The hash therefore only
+/// covers the head and the tail of the file and blocks sampled evenly in between. Together with the
+/// size and modification time this detects a replaced or regenerated file.
+std::optional<SourceKey> sourceKeyFor(const std::filesystem::path & path)
+{
+    std::error_code ec;
+    SourceKey key{};
+    key.size = std::filesystem::file_size(path, ec);
+    if(ec) {
+        return {};
+    }
+    key.modificationTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    if(ec) {
+        return {};
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if(!file) {
+        return {};
+    }
+    constexpr uint64_t edgeSize    = 1 << 16;
+    constexpr uint64_t sampleSize  = 1 << 12;
+    constexpr uint64_t sampleCount = 16;
+    std::vector<char> buffer(edgeSize);
+    auto hashRange = [&file, &buffer, &key](uint64_t offset, uint64_t size) {
+        size = std::min(size, key.size - std::min(offset, key.size));
+        file.seekg(static_cast<std::streamoff>(offset));
+        file.read(buffer.data(), static_cast<std::streamsize>(size));
+        fnv1a(key.hash, buffer.data(), static_cast<size_t>(file.gcount()));
+    };
+    key.hash = 0xcbf29ce484222325ULL;
+    hashRange(0, edgeSize);
+    if(key.size > 2 * edgeSize) {
+        const uint64_t stride = (key.size - 2 * edgeSize) / (sampleCount + 1);
+        for(uint64_t i = 1; i <= sampleCount; ++i) {
+            hashRange(edgeSize + i * stride, sampleSize);
+        }
+        hashRange(key.size - edgeSize, edgeSize);
+    } else if(key.size > edgeSize) {
+        hashRange(edgeSize, edgeSize);
+    }
+    if(file.bad()) {
+        return {};
+    }
+    return key;
+}
+
+template <typename T>
+void writeRange(std::ofstream & out, const T * data, size_t size)
+{
+    if(size == 0) {
+        return;
+    }
+    out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size * sizeof(T)));
+}
+
+template <typename T>
+void writeColumn(std::ofstream & out, const std::vector<T> & column)
+{
+    writeRange(out, column.data(), column.size());
+}
+} // namespace
+
+namespace Parsing
+{
+std::filesystem::path cachePathFor(const std::filesystem::path & trajectoryPath)
+{
+    auto path = trajectoryPath;
+    path += ".jpsviscache";
+    return path;
+}
+
+bool hasValidTrajectoryCache(const std::filesystem::path & trajectoryPath)
+{
+    const auto cachePath = cachePathFor(trajectoryPath);
+    std::error_code ec;
+    if(!std::filesystem::is_regular_file(cachePath, ec)) {
+        return false;
+    }
+    std::ifstream cache(cachePath, std::ios::binary);
+    CacheHeader header{};
+    if(!cache.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+        return false;
+    }
+    if(header.magic != cacheMagic || header.version != cacheVersion ||
+       header.byteOrder != byteOrderMark) {
+        return false;
+    }
+    const auto expectedSize = sizeof(CacheHeader) + (header.frameCount + 1) * sizeof(uint64_t) +
+                              header.frameCount * sizeof(FrameBlock::FrameStats) +
+                              header.elementCount * (numFloatColumns * sizeof(float) +
+                                                     sizeof(int32_t));
+    if(std::filesystem::file_size(cachePath, ec) != expectedSize || ec) {
+        return false;
+    }
+    const auto key = sourceKeyFor(trajectoryPath);
+    return key && key->size == header.sourceSize &&
+           key->modificationTime == header.sourceModificationTime &&
+           key->hash == header.sourceHash;
+}
+
+bool writeTrajectoryCache(
+    const std::filesystem::path & trajectoryPath,
+    const TrajectoryData & trajectories)
+{
+    const auto key = sourceKeyFor(trajectoryPath);
+    if(!key) {
+        return false;
+    }
+    const int frameCount = trajectories.getFrameCount();
+    CacheHeader header{};
+    header.sourceSize             = key->size;
+    header.sourceModificationTime = key->modificationTime;
+    header.sourceHash             = key->hash;
+    header.fps                    = trajectories.getFps();
+    header.frameCount             = static_cast<uint64_t>(frameCount);
+
+    // Only views of the frames are collected, the columns are written straight from the blocks
+    std::vector<Frame> frames{};
+    frames.reserve(header.frameCount);
+    std::vector<uint64_t> offsets{};
+    offsets.reserve(header.frameCount + 1);
+    offsets.push_back(0);
+    for(int i = 0; i < frameCount; ++i) {
+        frames.push_back(trajectories.frameAt(i));
+        offsets.push_back(offsets.back() + frames.back().Size());
+    }
+    header.elementCount = offsets.back();
+
+    std::vector<FrameBlock::FrameStats> stats{};
+    stats.reserve(header.frameCount);
+    const FrameBlock * block = nullptr;
+    size_t indexInBlock      = 0;
+    for(const auto & frame : frames) {
+        // the frames of a block follow each other starting with its first frame
+        indexInBlock = frame.Block().get() == block ? indexInBlock + 1 : 0;
+        block        = frame.Block().get();
+        if(block != nullptr && indexInBlock < block->frameCount() &&
+           block->columns().x + block->frameBegin(indexInBlock) == frame.Columns().x) {
+            stats.push_back(block->frameStats(indexInBlock));
+            continue;
+        }
+        auto & frameStats  = stats.emplace_back();
+        const auto columns = frame.Columns();
+        for(int e = 0; e < frame.Size(); ++e) {
+            frameStats.add(columns.x[e], columns.y[e], columns.color[e]);
+        }
+    }
+
+    const auto cachePath = cachePathFor(trajectoryPath);
+    auto tmpPath         = cachePath;
+    tmpPath += ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        writeColumn(out, offsets);
+        writeColumn(out, stats);
+        for(const auto column : floatColumns) {
+            for(const auto & frame : frames) {
+                writeRange(out, frame.Columns().*column, static_cast<size_t>(frame.Size()));
+            }
+        }
+        for(const auto & frame : frames) {
+            writeRange(out, frame.Columns().id, static_cast<size_t>(frame.Size()));
+        }
+        if(!out) {
+            Log::Warning("Could not write trajectory cache <%s>", tmpPath.string().c_str());
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, cachePath, ec);
+    if(ec) {
+        Log::Warning(
+            "Could not write trajectory cache <%s>: %s",
+            cachePath.string().c_str(),
+            ec.message().c_str());
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    Log::Info("Wrote trajectory cache <%s>", cachePath.string().c_str());
+    return true;
+}
+
+bool loadTrajectoryCache(
+    const std::filesystem::path & trajectoryPath,
+    TrajectoryData * trajectories)
+{
+    if(!hasValidTrajectoryCache(trajectoryPath)) {
+        return false;
+    }
+    const auto cachePath = cachePathFor(trajectoryPath);
+    Log::Info("loading trajectory cache <%s> ", cachePath.string().c_str());
+    auto cacheFile = std::make_unique<QFile>(QString::fromStdString(cachePath.string()));
+    if(!cacheFile->open(QIODevice::ReadOnly)) {
+        Log::Error("could not open the file  <%s>", cachePath.string().c_str());
+        return false;
+    }
+    const uchar * mapped = cacheFile->map(0, cacheFile->size());
+    if(mapped == nullptr) {
+        Log::Error("could not memory map <%s>", cachePath.string().c_str());
+        return false;
+    }
+    // The mapping stays in place as long as any frame refers to it
+    std::shared_ptr<QFile> mapping(cacheFile.release(), [mapped](QFile * file) {
+        file->unmap(const_cast<uchar *>(mapped));
+        delete file;
+    });
+
+    CacheHeader header{};
+    std::memcpy(&header, mapped, sizeof(header));
+    const auto * offsets = reinterpret_cast<const uint64_t *>(mapped + sizeof(header));
+    const auto * stats =
+        reinterpret_cast<const FrameBlock::FrameStats *>(offsets + header.frameCount + 1);
+    FrameBlock::Columns columns{};
+    const auto * cur = reinterpret_cast<const float *>(stats + header.frameCount);
+    for(const auto column : floatColumns) {
+        columns.*column = cur;
+        cur += header.elementCount;
+    }
+    columns.id = reinterpret_cast<const int32_t *>(cur);
+
+    trajectories->clearFrames();
+    trajectories->setFps(header.fps);
+    trajectories->append(std::make_shared<FrameBlock>(
+        std::move(mapping),
+        columns,
+        std::vector<uint64_t>(offsets, offsets + header.frameCount + 1),
+        std::vector<FrameBlock::FrameStats>(stats, stats + header.frameCount)));
+    return true;
+}
+} // namespace Parsing
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <filesystem>
+
+class TrajectoryData;
+
+/// Binary columnar cache of a parsed trajectory txt file.
+/// The cache is stored next to the txt file (see cachePathFor()) and allows to reopen a trajectory
+/// without parsing the text again. It consists of a fixed size header followed by these arrays:
+///  - frame offsets, uint64 [frameCount + 1], elements of frame i are [offset[i], offset[i+1])
+///  - frame statistics, FrameBlock::FrameStats [frameCount], so loading does not read the columns
+///  - x, y, z, radius a, radius b, angle, color, float32 [elementCount] each
+///  - agent ids, int32 [elementCount]
+/// Lengths are stored in cm, i.e. as used by FrameElement. The header records size, modification
+/// time and a content hash of the txt file, a cache that does not match the txt file is ignored.
+namespace Parsing
+{
+/// @param trajectoryPath path to the trajectory txt file
+/// @return path of the cache file belonging to 'trajectoryPath'
+std::filesystem::path cachePathFor(const std::filesystem::path & trajectoryPath);
+
+/// Checks whether a cache exists for 'trajectoryPath' that has been created from the current
+/// content of the txt file.
+/// @param trajectoryPath path to the trajectory txt file
+/// @return true if the cache can be used
+bool hasValidTrajectoryCache(const std::filesystem::path & trajectoryPath);
+
+/// Writes the cache for 'trajectoryPath' containing all frames of 'trajectories'. The cache is
+/// written to a temporary file first and renamed afterwards, an existing cache is replaced.
+/// @param trajectoryPath path to the trajectory txt file 'trajectories' has been parsed from
+/// @param trajectories to store
+/// @return true on success
+bool writeTrajectoryCache(
+    const std::filesystem::path & trajectoryPath,
+    const TrajectoryData & trajectories);
+
+/// Loads the frames of 'trajectoryPath' from its cache. The cache is memory mapped and validated
+/// against the txt file before it is used. The frames refer to the mapped columns directly, the
+/// mapping is released together with the last frame.
+/// @param trajectoryPath path to the trajectory txt file
+/// @param trajectories receives the frames, existing frames are cleared
+/// @return true on success, false if there is no valid cache
+bool loadTrajectoryCache(
+    const std::filesystem::path & trajectoryPath,
+    TrajectoryData * trajectories);
+} // namespace Parsing
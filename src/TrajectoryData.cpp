@@ -4,31 +4,61 @@
 
 void TrajectoryData::resetFrameCursor()
 {
+    std::lock_guard lock(_framesMutex);
     _frameCursor = 0;
 }
 
 unsigned int TrajectoryData::getSize()
 {
-    if(_frames.empty())
-        return 0;
-    else
-        return _frames.size();
+    std::lock_guard lock(_framesMutex);
+    return frameCount();
 }
 
-void TrajectoryData::append(std::unique_ptr<Frame> && frame)
+void TrajectoryData::append(std::shared_ptr<const FrameBlock> block)
 {
-    _frames.emplace_back(std::move(frame));
+    std::lock_guard lock(_framesMutex);
+    for(size_t index = 0; index < block->frameCount(); ++index) {
+        _frames.emplace_back(block, index);
+        _pyramid.append(block->frameStats(index));
+    }
 }
 
-void TrajectoryData::clearFrames()
+void TrajectoryData::setOutOfCore(std::shared_ptr<OutOfCoreTrajectory> outOfCore)
 {
+    std::lock_guard lock(_framesMutex);
     _frameCursor = 0;
+    ++_generation;
     _frames.clear();
+    _pyramid.clear();
+    _outOfCore = std::move(outOfCore);
+}
+
+void TrajectoryData::clearFrames()
+{
+    std::shared_ptr<OutOfCoreTrajectory> outOfCore{};
+    {
+        std::lock_guard lock(_framesMutex);
+        _frameCursor = 0;
+        ++_generation;
+        _frames.clear();
+        _pyramid.clear();
+        // destroyed outside of the lock, this waits for its prefetch thread
+        outOfCore = std::move(_outOfCore);
+    }
+    std::lock_guard lock(_tracksMutex);
+    _agentTracks.clear();
+}
+
+int TrajectoryData::getFrameCount() const
+{
+    std::lock_guard lock(_framesMutex);
+    return frameCount();
 }
 
-int TrajectoryData::getFrameCount()
+unsigned int TrajectoryData::getGeneration() const
 {
-    return _frames.size();
+    std::lock_guard lock(_framesMutex);
+    return _generation;
 }
 
 double TrajectoryData::getFps() const
@@ -43,27 +73,189 @@ void TrajectoryData::setFps(double val)
 
 int TrajectoryData::currentIndex()
 {
+    std::lock_guard lock(_framesMutex);
     return _frameCursor;
 }
 
 void TrajectoryData::moveToFrame(int position)
 {
-    if(position >= 0 && position < _frames.size()) {
+    std::lock_guard lock(_framesMutex);
+    if(position >= 0 && position < frameCount()) {
         _frameCursor = position;
     } else {
         _frameCursor = 0;
     }
+    if(_outOfCore) {
+        _outOfCore->setCursor(_frameCursor, 0);
+    }
 }
 
 void TrajectoryData::moveFrameBy(int count)
 {
+    std::lock_guard lock(_framesMutex);
     const auto newIndex = _frameCursor + count;
     const int low       = 0;
-    const int high      = _frames.empty() ? 0 : static_cast<int>(_frames.size() - 1);
+    const int high      = std::max(frameCount() - 1, 0);
     _frameCursor        = std::clamp(newIndex, low, high);
+    if(_outOfCore) {
+        _outOfCore->setCursor(_frameCursor, count);
+    }
+}
+
+Frame TrajectoryData::currentFrame() const
+{
+    std::shared_ptr<OutOfCoreTrajectory> outOfCore{};
+    int cursor{0};
+    {
+        std::lock_guard lock(_framesMutex);
+        if(!_outOfCore) {
+            return _frames.empty() ? Frame{} : _frames[_frameCursor];
+        }
+        outOfCore = _outOfCore;
+        cursor    = _frameCursor;
+    }
+    // decoding a frame may take a while, do not block other threads meanwhile
+    return outOfCore->frameCount() > cursor ? outOfCore->frame(cursor) : Frame{};
+}
+
+Frame TrajectoryData::frameAt(int index) const
+{
+    std::shared_ptr<OutOfCoreTrajectory> outOfCore{};
+    {
+        std::lock_guard lock(_framesMutex);
+        if(!_outOfCore) {
+            return frameAtLocked(index);
+        }
+        outOfCore = _outOfCore;
+    }
+    return outOfCore->frame(index);
+}
+
+std::pair<Frame, Frame> TrajectoryData::framesAt(int index) const
+{
+    std::shared_ptr<OutOfCoreTrajectory> outOfCore{};
+    {
+        std::lock_guard lock(_framesMutex);
+        if(!_outOfCore) {
+            return {frameAtLocked(index), frameAtLocked(index + 1)};
+        }
+        outOfCore = _outOfCore;
+    }
+    // the out-of-core trajectory is never cleared, only replaced as a whole
+    return {outOfCore->frame(index), outOfCore->frame(index + 1)};
+}
+
+size_t TrajectoryData::getAgentCount() const
+{
+    std::lock_guard lock(_tracksMutex);
+    updateAgentTracks();
+    return _agentTracks.agentCount();
 }
 
-Frame * TrajectoryData::currentFrame()
+std::optional<AgentTracks::Track> TrajectoryData::agentTrack(int agentId) const
 {
-    return _frames[_frameCursor].get();
+    std::lock_guard lock(_tracksMutex);
+    updateAgentTracks();
+    const auto agent = _agentTracks.denseIndex(agentId);
+    if(!agent) {
+        return std::nullopt;
+    }
+    return _agentTracks.track(agent.value());
+}
+
+std::optional<FrameElement> TrajectoryData::agentAt(int agentId, int index) const
+{
+    std::shared_ptr<OutOfCoreTrajectory> outOfCore{};
+    {
+        std::lock_guard tracksLock(_tracksMutex);
+        updateAgentTracks();
+        std::lock_guard lock(_framesMutex);
+        if(!_outOfCore) {
+            const auto agent = _agentTracks.denseIndex(agentId);
+            if(!agent) {
+                return std::nullopt;
+            }
+            const int element = _agentTracks.elementIndex(agent.value(), index);
+            // the frames may have been replaced since they were indexed
+            const auto frame = frameAtLocked(index);
+            if(element < 0 || element >= frame.Size() || _tracksGeneration != _generation) {
+                return std::nullopt;
+            }
+            return frame.ElementAt(element);
+        }
+        outOfCore = _outOfCore;
+    }
+    if(index < 0 || index >= outOfCore->frameCount()) {
+        return std::nullopt;
+    }
+    const auto frame   = outOfCore->frame(index);
+    const auto columns = frame.Columns();
+    for(int element = 0; element < frame.Size(); ++element) {
+        if(columns.id[element] == agentId) {
+            return frame.ElementAt(element);
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<TemporalPyramid::Summary> TrajectoryData::getSummaries(int level) const
+{
+    std::lock_guard lock(_framesMutex);
+    if(level < 0 || level >= _pyramid.levelCount()) {
+        return {};
+    }
+    return _pyramid.level(level);
+}
+
+Frame TrajectoryData::frameAtLocked(int index) const
+{
+    if(index < 0 || static_cast<size_t>(index) >= _frames.size()) {
+        return Frame{};
+    }
+    return _frames[index];
+}
+
+void TrajectoryData::updateAgentTracks() const
+{
+    // the new frames are only collected under the lock of the frames, indexing their elements
+    // does not block appending or displaying frames
+    std::vector<Frame> frames{};
+    {
+        std::lock_guard lock(_framesMutex);
+        if(_tracksGeneration != _generation) {
+            _agentTracks.clear();
+            _tracksGeneration = _generation;
+        }
+        const auto indexed = static_cast<size_t>(_agentTracks.frameCount());
+        if(indexed < _frames.size()) {
+            frames.assign(_frames.begin() + indexed, _frames.end());
+        }
+    }
+    for(const auto & frame : frames) {
+        _agentTracks.append(frame);
+    }
+}
+
+int TrajectoryData::frameCount() const
+{
+    return _outOfCore ? _outOfCore->frameCount() : static_cast<int>(_frames.size());
+}
+
+size_t TrajectoryData::memoryUsage() const
+{
+    std::lock_guard tracksLock(_tracksMutex);
+    std::lock_guard lock(_framesMutex);
+    if(_outOfCore) {
+        return _outOfCore->memoryUsage();
+    }
+    size_t bytes                 = _frames.capacity() * sizeof(Frame);
+    const FrameBlock * lastBlock = nullptr;
+    for(const auto & frame : _frames) {
+        // frames of a block are stored consecutively
+        if(frame.Block().get() != lastBlock) {
+            lastBlock = frame.Block().get();
+            bytes += lastBlock->memoryUsage();
+        }
+    }
+    return bytes + _agentTracks.memoryUsage() + _pyramid.memoryUsage();
 }
@@ -1,13 +1,44 @@
 #pragma once
+#include "AgentTracks.h"
 #include "Frame.h"
+#include "FrameBlock.h"
+#include "OutOfCoreTrajectory.h"
+#include "TemporalPyramid.h"
 
+#include <cstddef>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
 #include <vector>
 
+/// Holds all frames of a trajectory and the cursor of the replay.
+/// The elements are stored column wise in FrameBlocks, each Frame is a view of a slice of a block.
+/// Frames may be appended from a background thread (see TrajectoryLoader) while the data is
+/// displayed, access to the frames is synchronized. Appended frames are never modified, Frames
+/// returned by currentFrame() or frameAt() stay valid even after clearFrames() has been called.
+/// In out-of-core mode (see setOutOfCore()) the frames are not held in memory but decoded on
+/// demand by an OutOfCoreTrajectory.
+/// The appended frames are indexed per agent (see AgentTracks), so the state of a single agent at
+/// any frame is found without scanning the frames. The index is brought up to date when it is
+/// queried, on the querying thread and without holding the lock of the frames, so appending and
+/// loading a cache do not pay for it. There is no such index in out-of-core mode, building it would
+/// need to decode the whole file. The same holds for the temporal pyramid (see
+/// TemporalPyramid) summarizing the appended frames at coarser resolutions.
 class TrajectoryData
 {
-    std::vector<std::unique_ptr<Frame>> _frames{};
+    mutable std::mutex _framesMutex{};
+    std::vector<Frame> _frames{};
+    std::shared_ptr<OutOfCoreTrajectory> _outOfCore{};
+    /// Guards the index of the agents, acquired before '_framesMutex' if both are needed
+    mutable std::mutex _tracksMutex{};
+    /// Index of the first frames, see updateAgentTracks()
+    mutable AgentTracks _agentTracks{};
+    /// Generation of the frames indexed in '_agentTracks'
+    mutable unsigned int _tracksGeneration{0};
+    TemporalPyramid _pyramid{};
     int _frameCursor{0};
+    unsigned int _generation{0};
     double _fps{0};
 
 public:
@@ -19,14 +50,24 @@ public:
     /// get the size
     unsigned int getSize();
 
-    /// add a frame to the synchronized data
-    void append(std::unique_ptr<Frame> && frame);
+    /// add all frames of 'block' to the synchronized data
+    /// @param block holding the frames to append, in order
+    void append(std::shared_ptr<const FrameBlock> block);
+
+    /// Switches to out-of-core mode, all frames are provided by 'outOfCore' from now on.
+    /// Frames appended before are discarded. clearFrames() leaves the out-of-core mode.
+    /// @param outOfCore provider of the frames
+    void setOutOfCore(std::shared_ptr<OutOfCoreTrajectory> outOfCore);
 
     /// clears all frames
     void clearFrames();
 
     /// returns the total number of frames
-    int getFrameCount();
+    int getFrameCount() const;
+
+    /// @return number of times the frames have been replaced by clearFrames() or setOutOfCore(),
+    /// frames with the same index and generation are the same
+    unsigned int getGeneration() const;
 
     /// Access the FPS this data was recorded with.
     /// @return fps the data was recored at
@@ -47,5 +88,54 @@ public:
     /// @param count frames to move.
     void moveFrameBy(int count);
 
-    Frame * currentFrame();
+    /// @return the frame at the cursor position, an empty frame if there are no frames
+    Frame currentFrame() const;
+
+    /// Access a frame independent of the frame cursor.
+    /// @param index of the frame
+    /// @return the frame at 'index', an empty frame without block if there is no such frame, e.g.
+    /// because the frames have been cleared concurrently
+    Frame frameAt(int index) const;
+
+    /// Access two consecutive frames, e.g. to interpolate between them. Both frames are looked up
+    /// at once, so they belong to the same trajectory even if the frames are cleared concurrently.
+    /// @param index of the first frame
+    /// @return the frames at 'index' and 'index' + 1, each an empty frame without block if there is
+    /// no such frame
+    std::pair<Frame, Frame> framesAt(int index) const;
+
+    /// @return number of distinct agents in the frames appended so far, 0 in out-of-core mode
+    size_t getAgentCount() const;
+
+    /// @param agentId id of the agent in the trajectory file
+    /// @return first and last frame the agent is present in, nothing if it is unknown or in
+    /// out-of-core mode
+    std::optional<AgentTracks::Track> agentTrack(int agentId) const;
+
+    /// Access the state of a single agent independent of the frame cursor. Constant time unless
+    /// in out-of-core mode, where the frame is searched for the agent.
+    /// @param agentId id of the agent in the trajectory file
+    /// @param index of the frame
+    /// @return the element of the agent in frame 'index', nothing if it is not present
+    std::optional<FrameElement> agentAt(int agentId, int index) const;
+
+    /// Access a level of the temporal pyramid
+    /// @param level of the pyramid, node i summarizes the frames [i * 2^level, (i + 1) * 2^level)
+    /// @return copy of the nodes of 'level', empty if there is no such level or in out-of-core mode
+    std::vector<TemporalPyramid::Summary> getSummaries(int level) const;
+
+    /// @return bytes used by the elements of all frames, by the frames themselves, the index of the
+    /// agents and the temporal pyramid
+    size_t memoryUsage() const;
+
+private:
+    /// @return number of frames, '_framesMutex' needs to be held
+    int frameCount() const;
+
+    /// @return frame 'index' of the frames held in memory, an empty frame if there is no such
+    /// frame, '_framesMutex' needs to be held
+    Frame frameAtLocked(int index) const;
+
+    /// Indexes the frames appended since the last call, '_tracksMutex' needs to be held
+    void updateAgentTracks() const;
 };
@@ -0,0 +1,146 @@
+#include "TrajectoryFollower.h"
+
+#include "Log.h"
+#include "TrajectoryData.h"
+#include "TxtParsing.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <algorithm>
+#include <string_view>
+
+TrajectoryFollower::TrajectoryFollower(QObject * parent) : QObject(parent)
+{
+    // The watcher does not report changes on all file systems, e.g. network shares, the timer
+    // makes sure appended data shows up nevertheless.
+    _pollTimer.setInterval(1000);
+    connect(&_pollTimer, &QTimer::timeout, this, &TrajectoryFollower::poll);
+    connect(&_watcher, &QFileSystemWatcher::fileChanged, this, &TrajectoryFollower::poll);
+}
+
+bool TrajectoryFollower::start(const QString & fileName, TrajectoryData * trajectories)
+{
+    stop();
+    if(!QFile::exists(fileName)) {
+        Log::Error("could not open the file  <%s>", fileName.toStdString().c_str());
+        return false;
+    }
+    Log::Info("following txt trajectory <%s> ", fileName.toStdString().c_str());
+    _fileName     = fileName;
+    _trajectories = trajectories;
+    _trajectories->setFps(0);
+    restart();
+    poll();
+    if(_trajectories->getFps() <= 0) {
+        Log::Warning("No frame rate found in <%s>, using 16 fps", fileName.toStdString().c_str());
+        _trajectories->setFps(16);
+    }
+    _watcher.addPath(_fileName);
+    _pollTimer.start();
+    return true;
+}
+
+void TrajectoryFollower::stop()
+{
+    if(!isFollowing()) {
+        return;
+    }
+    _pollTimer.stop();
+    if(!_watcher.files().isEmpty()) {
+        _watcher.removePaths(_watcher.files());
+    }
+    publishHeldBackFrame();
+    _parser.reset();
+    _fileName.clear();
+    Log::Info("Stopped following trajectory file");
+}
+
+bool TrajectoryFollower::isFollowing() const
+{
+    return !_fileName.isEmpty();
+}
+
+void TrajectoryFollower::poll()
+{
+    if(!isFollowing()) {
+        return;
+    }
+    // A file that has been replaced is no longer watched
+    if(!_watcher.files().contains(_fileName) && QFile::exists(_fileName)) {
+        _watcher.addPath(_fileName);
+    }
+    QFile file(_fileName);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const int64_t fileSize = file.size();
+    if(fileSize < _offset) {
+        Log::Info("Trajectory file has been truncated, reading it again");
+        restart();
+    }
+    if(fileSize == _offset) {
+        return;
+    }
+
+    // Read in pieces to keep the UI responsive when starting to follow a large file
+    constexpr int64_t maxReadSize = 32 << 20;
+    file.seek(_offset);
+    const QByteArray bytes = file.read(std::min(fileSize - _offset, maxReadSize));
+    std::string_view data(bytes.constData(), static_cast<size_t>(bytes.size()));
+
+    // Only complete lines are parsed, the rest is read again once the line has been completed
+    const auto lastLineBreak = data.rfind('\n');
+    if(lastLineBreak == std::string_view::npos) {
+        return;
+    }
+    data = data.substr(0, lastLineBreak + 1);
+
+    if(!_headerRead) {
+        const auto header = Parsing::parseTxtHeader(data);
+        if(header.dataOffset == data.size()) {
+            // no data line yet, the header might not be complete
+            return;
+        }
+        if(header.fps) {
+            Log::Info("Frame rate  <%.0f>", header.fps.value());
+            _trajectories->setFps(header.fps.value());
+        }
+        _parser = std::make_unique<Parsing::TxtStreamParser>(
+            _trajectories, 0, header.lineCount, header.layout);
+        _headerRead = true;
+        _offset += static_cast<int64_t>(header.dataOffset);
+        data.remove_prefix(header.dataOffset);
+    }
+
+    const int frameCountBefore = _trajectories->getFrameCount();
+    _parser->feed(data);
+    _offset += static_cast<int64_t>(data.size());
+    const int frameCount = _trajectories->getFrameCount();
+    if(frameCount != frameCountBefore) {
+        emit framesAppended(frameCount);
+    }
+    if(_offset < fileSize) {
+        QTimer::singleShot(0, this, &TrajectoryFollower::poll);
+    }
+}
+
+void TrajectoryFollower::publishHeldBackFrame()
+{
+    if(!_parser) {
+        return;
+    }
+    const int frameCountBefore = _trajectories->getFrameCount();
+    _parser->finish();
+    const int frameCount = _trajectories->getFrameCount();
+    if(frameCount != frameCountBefore) {
+        emit framesAppended(frameCount);
+    }
+}
+
+void TrajectoryFollower::restart()
+{
+    _trajectories->clearFrames();
+    _parser.reset();
+    _offset     = 0;
+    _headerRead = false;
+}
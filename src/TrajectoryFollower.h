@@ -0,0 +1,68 @@
+#pragma once
+
+#include "TxtStreamParser.h"
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <cstdint>
+#include <memory>
+
+class TrajectoryData;
+
+/// Follows a trajectory txt file that is still being written, e.g. by a running jpscore, like
+/// 'tail -f' does.
+/// The file is watched for changes and polled periodically. Only the bytes appended since the last
+/// read are parsed, up to the last complete line. A partially written last line is read again with
+/// the next change. The frame with the highest id is held back until a later frame shows up, as
+/// jpscore may still write records of it (see TxtStreamParser). A file that did not grow for a
+/// while does not mean the frame is complete, jpscore writes buffered and computing the next
+/// output interval may take long. The held back frame is therefore only published when following
+/// stops.
+/// If the file shrinks, e.g. because the simulation was restarted, it is read again from the start.
+class TrajectoryFollower : public QObject
+{
+    Q_OBJECT
+
+    QFileSystemWatcher _watcher{};
+    QTimer _pollTimer{};
+    QString _fileName{};
+    TrajectoryData * _trajectories{nullptr};
+    std::unique_ptr<Parsing::TxtStreamParser> _parser{};
+    /// Offset of the first byte not parsed yet
+    int64_t _offset{0};
+    bool _headerRead{false};
+
+public:
+    explicit TrajectoryFollower(QObject * parent = nullptr);
+    ~TrajectoryFollower() override = default;
+
+    /// Starts following 'fileName'. The data available now is read before this returns. Following
+    /// a different file stops following the previous one.
+    /// @param fileName of the trajectory txt file
+    /// @param trajectories receives the frames, is cleared first and has to outlive the follower
+    /// @return false if the file could not be opened
+    bool start(const QString & fileName, TrajectoryData * trajectories);
+
+    /// Stops following the file, the frames read so far are kept.
+    void stop();
+
+    /// @return true while a file is followed
+    bool isFollowing() const;
+
+signals:
+    /// Emitted after new frames have been appended.
+    /// @param frameCount number of frames available now
+    void framesAppended(int frameCount);
+
+private:
+    /// Reads and parses the data appended since the last call
+    void poll();
+
+    /// Publishes the frame held back by the parser and reports records that had to be dropped
+    void publishHeldBackFrame();
+
+    /// Starts over at the beginning of the file
+    void restart();
+};
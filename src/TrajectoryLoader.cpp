@@ -0,0 +1,201 @@
+#include "TrajectoryLoader.h"
+
+#include "Log.h"
+#include "OutOfCoreTrajectory.h"
+#include "Parsing.h"
+#include "TrajectoryCache.h"
+#include "TrajectoryData.h"
+#include "TxtParsing.h"
+#include "TxtStreamParser.h"
+
+#include <QFile>
+#include <QMetaObject>
+#include <algorithm>
+#include <memory>
+
+TrajectoryLoader::TrajectoryLoader(QObject * parent) : QObject(parent)
+{
+    connect(
+        this,
+        &TrajectoryLoader::workerDone,
+        this,
+        &TrajectoryLoader::onWorkerDone,
+        Qt::QueuedConnection);
+}
+
+TrajectoryLoader::~TrajectoryLoader()
+{
+    cancel();
+}
+
+bool TrajectoryLoader::start(
+    const QString & fileName,
+    TrajectoryData * trajectories,
+    bool outOfCore)
+{
+    cancel();
+    ++_generation;
+    _trajectories = trajectories;
+    _trajectories->clearFrames();
+    _outOfCore = outOfCore;
+
+    Log::Info("loading txt trajectory <%s> ", fileName.toStdString().c_str());
+    _path     = fileName.toStdString();
+    auto file = std::make_unique<QFile>(fileName);
+    if(!file->open(QIODevice::ReadOnly)) {
+        Log::Error("could not open the file  <%s>", fileName.toStdString().c_str());
+        return false;
+    }
+    const auto fileSize  = file->size();
+    const uchar * mapped = fileSize > 0 ? file->map(0, fileSize) : nullptr;
+    if(fileSize > 0 && mapped == nullptr) {
+        // Without a mapping the file is parsed right away, as it was done before
+        Log::Warning(
+            "could not memory map <%s>, loading the file at once",
+            fileName.toStdString().c_str());
+        file->close();
+        const bool success = Parsing::ParseTxtFormatTextStream(fileName, trajectories);
+        QMetaObject::invokeMethod(
+            this,
+            [this, success]() {
+                emit progressChanged(100);
+                emit finished(success);
+            },
+            Qt::QueuedConnection);
+        return success;
+    }
+    _data = mapped == nullptr ? std::string_view{} :
+                                std::string_view(reinterpret_cast<const char *>(mapped), fileSize);
+    // Shared with the OutOfCoreTrajectory in out-of-core mode
+    _mapping = std::shared_ptr<QFile>(file.release(), [mapped](QFile * mappedFile) {
+        if(mapped != nullptr) {
+            mappedFile->unmap(const_cast<uchar *>(mapped));
+        }
+        delete mappedFile;
+    });
+
+    const auto header = Parsing::parseTxtHeader(_data);
+    if(header.fps) {
+        Log::Info("Frame rate  <%.0f>", header.fps.value());
+        _trajectories->setFps(header.fps.value());
+    } else {
+        Log::Warning("No frame rate found in <%s>, using 16 fps", fileName.toStdString().c_str());
+        _trajectories->setFps(16);
+    }
+    _dataOffset      = header.dataOffset;
+    _headerLineCount = header.lineCount;
+    _layout          = header.layout;
+
+    _cancel = false;
+    _worker = std::thread([this, generation = _generation]() {
+        run();
+        emit workerDone(generation);
+    });
+    return true;
+}
+
+void TrajectoryLoader::cancel()
+{
+    if(!_worker.joinable()) {
+        return;
+    }
+    _cancel = true;
+    _worker.join();
+    release();
+    Log::Info("Loading of trajectories cancelled");
+}
+
+bool TrajectoryLoader::isLoading() const
+{
+    return _worker.joinable();
+}
+
+void TrajectoryLoader::run()
+{
+    if(_outOfCore) {
+        if(runOutOfCore() || _cancel) {
+            return;
+        }
+        // Not ordered by frame, load the whole file instead
+        _trajectories->clearFrames();
+    }
+
+    // Parse the data in batches, every batch publishes the frames it completed. The batch size is
+    // a trade off between the latency of the first frames / the cancellation and the benefit of
+    // parsing a batch with multiple threads.
+    constexpr size_t batchSize = 32 << 20;
+    Parsing::TxtStreamParser parser(_trajectories, 0, _headerLineCount, _layout);
+    size_t offset = _dataOffset;
+    while(offset < _data.size() && !_cancel) {
+        size_t end = std::min(offset + batchSize, _data.size());
+        if(end < _data.size()) {
+            const auto eol = _data.find('\n', end);
+            end            = eol == std::string_view::npos ? _data.size() : eol + 1;
+        }
+        parser.feed(_data.substr(offset, end - offset));
+        offset = end;
+        emit progressChanged(static_cast<int>(100 * offset / _data.size()));
+    }
+    if(_cancel) {
+        return;
+    }
+    parser.finish();
+    if(!parser.isOrdered()) {
+        reloadAtOnce();
+    }
+    Parsing::writeTrajectoryCache(_path, *_trajectories);
+}
+
+void TrajectoryLoader::reloadAtOnce()
+{
+    // Records of already displayed frames had to be dropped. The data is parsed again in one go,
+    // which never drops records, while the frames loaded so far stay on display.
+    Log::Warning("Reloading unordered trajectory data at once");
+    TrajectoryData reloaded;
+    Parsing::TxtStreamParser parser(&reloaded, 0, _headerLineCount, _layout);
+    parser.feed(_data.substr(_dataOffset));
+    parser.finish();
+
+    _trajectories->clearFrames();
+    const FrameBlock * lastBlock = nullptr;
+    for(int index = 0; index < reloaded.getFrameCount(); ++index) {
+        // frames of a block are stored consecutively
+        const auto block = reloaded.frameAt(index).Block();
+        if(block.get() != lastBlock) {
+            lastBlock = block.get();
+            _trajectories->append(block);
+        }
+    }
+}
+
+bool TrajectoryLoader::runOutOfCore()
+{
+    auto outOfCore =
+        std::make_shared<OutOfCoreTrajectory>(_mapping, _data.substr(_dataOffset), _layout);
+    _trajectories->setOutOfCore(outOfCore);
+    return outOfCore->buildIndex(_cancel, [this](double fraction) {
+        emit progressChanged(static_cast<int>(100 * fraction));
+    });
+}
+
+void TrajectoryLoader::onWorkerDone(unsigned int generation)
+{
+    if(generation != _generation || !_worker.joinable()) {
+        // notification of a load that has been cancelled in the meantime
+        return;
+    }
+    _worker.join();
+    release();
+    Log::Info(
+        "Loaded %d frames, trajectory data uses %.1f MiB",
+        _trajectories->getFrameCount(),
+        _trajectories->memoryUsage() / (1024.0 * 1024.0));
+    emit progressChanged(100);
+    emit finished(true);
+}
+
+void TrajectoryLoader::release()
+{
+    _data = {};
+    _mapping.reset();
+}
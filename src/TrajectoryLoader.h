@@ -0,0 +1,82 @@
+#pragma once
+
+#include "TxtParsing.h"
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+class TrajectoryData;
+
+/// Loads a trajectory txt file on a background thread.
+/// The header is read synchronously in start(), the data section is parsed afterwards in batches
+/// and every completed frame is appended to the TrajectoryData right away. This allows to display
+/// and replay the frames loaded so far while the rest of the file is still being parsed.
+/// Progress is reported with progressChanged(), the end of the loading with finished(). Both
+/// signals are delivered in the thread the loader lives in.
+/// After a complete load the binary cache of the file is written, see TrajectoryCache.h.
+/// In out-of-core mode only an index of the frames is built, see OutOfCoreTrajectory.
+class TrajectoryLoader : public QObject
+{
+    Q_OBJECT
+
+    std::thread _worker{};
+    std::atomic<bool> _cancel{false};
+    /// Identifies the current load, used to ignore notifications of a cancelled load
+    unsigned int _generation{0};
+    bool _outOfCore{false};
+    /// Keeps the memory mapping of the file alive
+    std::shared_ptr<const void> _mapping{};
+    std::filesystem::path _path{};
+    std::string_view _data{};
+    size_t _dataOffset{0};
+    size_t _headerLineCount{0};
+    Parsing::TxtLayout _layout{};
+    TrajectoryData * _trajectories{nullptr};
+
+public:
+    explicit TrajectoryLoader(QObject * parent = nullptr);
+    ~TrajectoryLoader() override;
+
+    /// Starts loading 'fileName' into 'trajectories'. A load in progress is cancelled first.
+    /// 'trajectories' is cleared and has to outlive the load.
+    /// @param fileName of the trajectory txt file
+    /// @param trajectories to append the frames to
+    /// @param outOfCore only index the frames and decode them on demand, for files that do not
+    /// fit into memory. Files not ordered by frame are loaded completely nevertheless.
+    /// @return false if the file could not be opened, true if loading has been started
+    bool start(const QString & fileName, TrajectoryData * trajectories, bool outOfCore = false);
+
+    /// Stops a load in progress and waits for the background thread. Frames loaded so far are
+    /// kept, finished() is not emitted.
+    void cancel();
+
+    /// @return true while a load is in progress
+    bool isLoading() const;
+
+signals:
+    /// Emitted whenever another part of the file has been parsed.
+    /// @param percent of the data section parsed so far
+    void progressChanged(int percent);
+
+    /// Emitted once the whole file has been loaded.
+    /// @param success false if the data could not be loaded
+    void finished(bool success);
+
+    /// Internal, emitted by the background thread once it is done
+    void workerDone(unsigned int generation);
+
+private:
+    void run();
+    bool runOutOfCore();
+    /// Replaces the frames loaded by parsing the whole data section at once, for data not ordered
+    /// by frame
+    void reloadAtOnce();
+    void onWorkerDone(unsigned int generation);
+    void release();
+};
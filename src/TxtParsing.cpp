@@ -0,0 +1,450 @@
+#include "TxtParsing.h"
+
+#include "general/Macros.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+
+namespace
+{
+bool isSeparator(char c)
+{
+    return c == '\t' || c == ' ';
+}
+
+std::string_view trimmed(std::string_view str)
+{
+    while(!str.empty() && (isSeparator(str.front()) || str.front() == '\r')) {
+        str.remove_prefix(1);
+    }
+    while(!str.empty() && (isSeparator(str.back()) || str.back() == '\r')) {
+        str.remove_suffix(1);
+    }
+    return str;
+}
+
+template <typename T>
+bool toNumber(std::string_view field, T & value)
+{
+    // std::from_chars does not accept a leading '+'
+    if(!field.empty() && field.front() == '+') {
+        field.remove_prefix(1);
+    }
+    const auto * end     = field.data() + field.size();
+    const auto [ptr, ec] = std::from_chars(field.data(), end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+/// Converts a field in fixed point notation with at most 15 significant digits, as written by
+/// jpscore, e.g. '-60.45'. The digits form an integer that is exactly representable as double and
+/// is divided by an exact power of ten, so the result is correctly rounded and equals the result
+/// of std::from_chars.
+/// @return false if 'field' is not of this form, the caller falls back to toNumber() then
+bool toFixedPoint(std::string_view field, double & value)
+{
+    constexpr size_t maxDigits = 15;
+    constexpr std::array<double, maxDigits + 1> powersOfTen{
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+
+    const char * cur       = field.data();
+    const char * const end = cur + field.size();
+    const bool negative    = cur < end && *cur == '-';
+    if(negative) {
+        ++cur;
+    }
+    uint64_t mantissa{0};
+    size_t digits{0};
+    size_t fractionDigits{0};
+    bool fraction{false};
+    for(; cur < end; ++cur) {
+        const unsigned digit = static_cast<unsigned char>(*cur) - '0';
+        if(digit < 10) {
+            mantissa = 10 * mantissa + digit;
+            ++digits;
+            fractionDigits += fraction;
+        } else if(*cur == '.' && !fraction && digits > 0) {
+            fraction = true;
+        } else {
+            return false;
+        }
+    }
+    if(digits == 0 || digits > maxDigits || (fraction && fractionDigits == 0)) {
+        return false;
+    }
+    value = static_cast<double>(mantissa) / powersOfTen[fractionDigits];
+    if(negative) {
+        value = -value;
+    }
+    return true;
+}
+
+/// Converts a field of a data line
+/// @return false if 'field' is not a number
+bool toField(std::string_view field, int & value)
+{
+    return toNumber(field, value);
+}
+
+/// Converts a field of a data line, fields in fixed point notation take the fast path
+/// @return false if 'field' is not a number
+bool toField(std::string_view field, double & value)
+{
+    return toFixedPoint(field, value) || toNumber(field, value);
+}
+
+bool startsWithIgnoreCase(std::string_view str, std::string_view prefix)
+{
+    if(str.size() < prefix.size()) {
+        return false;
+    }
+    for(size_t i = 0; i < prefix.size(); ++i) {
+        if(std::tolower(static_cast<unsigned char>(str[i])) != prefix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Mirrors the previous header handling: a header line of the form '#<key>:<value>' where key
+/// contains 'framerate' (case insensitive) defines the fps.
+std::optional<double> parseFramerate(std::string_view line)
+{
+    const auto colon = line.find(':');
+    if(colon == std::string_view::npos || line.find(':', colon + 1) != std::string_view::npos) {
+        return {};
+    }
+    const auto key     = line.substr(0, colon);
+    bool keyMatches    = false;
+    const auto keyword = std::string_view("framerate");
+    for(size_t i = 0; i + keyword.size() <= key.size() && !keyMatches; ++i) {
+        keyMatches = startsWithIgnoreCase(key.substr(i), keyword);
+    }
+    if(!keyMatches) {
+        return {};
+    }
+    double fps{0};
+    if(!toNumber(trimmed(line.substr(colon + 1)), fps)) {
+        return {};
+    }
+    return fps;
+}
+
+/// Moves 'cur' past the next field of the line ending at 'end'
+/// @param field receives the field
+/// @return false if there is no further field
+bool nextField(const char *& cur, const char * end, std::string_view & field)
+{
+    while(cur < end && isSeparator(*cur)) {
+        ++cur;
+    }
+    const char * fieldBegin = cur;
+    while(cur < end && !isSeparator(*cur)) {
+        ++cur;
+    }
+    field = std::string_view(fieldBegin, cur - fieldBegin);
+    return cur != fieldBegin;
+}
+
+/// Converts the next fields of 'line' into 'values', one field per value in order
+/// @return false if a field is missing or malformed
+template <typename... T>
+bool readFields(std::string_view line, T &... values)
+{
+    const char * cur       = line.data();
+    const char * const end = cur + line.size();
+    std::string_view field{};
+    return ((nextField(cur, end, field) && toField(field, values)) && ...);
+}
+
+/// Values of a record in the units of the file, i.e. lengths in m. Columns missing in the file
+/// keep the defaults.
+struct RecordValues {
+    int agentID{-1};
+    double x{0};
+    double y{0};
+    double z{0};
+    double a{0.3};
+    double b{0.3};
+    double angle{30};
+    double color{155};
+};
+
+/// Stores 'values' as element of 'record', converting the lengths to cm
+void storeRecord(const RecordValues & values, Parsing::TxtRecord & record)
+{
+    record.element = FrameElement{
+        {values.x * FAKTOR, values.y * FAKTOR, values.z * FAKTOR},
+        {values.a * FAKTOR, values.b * FAKTOR, 0.3 * FAKTOR},
+        {0, 0, values.angle},
+        values.color,
+        values.agentID - 1};
+}
+
+/// @return the meaning of the column called 'name'
+Parsing::TxtColumn columnNamed(std::string_view name)
+{
+    using Parsing::TxtColumn;
+    constexpr std::array<std::pair<std::string_view, TxtColumn>, 9> names{
+        {{"id", TxtColumn::ID},
+         {"fr", TxtColumn::FR},
+         {"x", TxtColumn::X},
+         {"y", TxtColumn::Y},
+         {"z", TxtColumn::Z},
+         {"a", TxtColumn::A},
+         {"b", TxtColumn::B},
+         {"angle", TxtColumn::ANGLE},
+         {"color", TxtColumn::COLOR}}};
+    for(const auto & [columnName, column] : names) {
+        if(name.size() == columnName.size() && startsWithIgnoreCase(name, columnName)) {
+            return column;
+        }
+    }
+    return TxtColumn::OTHER;
+}
+} // namespace
+
+namespace Parsing
+{
+TxtHeader parseTxtHeader(std::string_view data)
+{
+    TxtHeader header{};
+    while(header.dataOffset < data.size()) {
+        const auto eol  = data.find('\n', header.dataOffset);
+        const auto last = eol == std::string_view::npos ? data.size() : eol;
+        const auto line = data.substr(header.dataOffset, last - header.dataOffset);
+        if(!line.empty() && line.front() == '#') {
+            if(const auto fps = parseFramerate(trimmed(line)); fps) {
+                header.fps = fps;
+            } else if(auto layout = parseTxtLayout(trimmed(line));
+                      layout.kind != TxtLayout::Kind::UNKNOWN) {
+                header.layout = std::move(layout);
+            }
+        } else if(!trimmed(line).empty()) {
+            break;
+        }
+        header.dataOffset = last == data.size() ? last : last + 1;
+        ++header.lineCount;
+    }
+    return header;
+}
+
+std::vector<std::string_view> splitAtLineBoundaries(std::string_view data, size_t count)
+{
+    std::vector<std::string_view> ranges{};
+    const size_t targetSize = data.size() / std::max<size_t>(count, 1);
+    size_t begin            = 0;
+    while(begin < data.size()) {
+        size_t end = ranges.size() + 1 == count ? data.size() : begin + targetSize;
+        if(end >= data.size()) {
+            end = data.size();
+        } else {
+            const auto eol = data.find('\n', end);
+            end            = eol == std::string_view::npos ? data.size() : eol + 1;
+        }
+        ranges.emplace_back(data.substr(begin, end - begin));
+        begin = end;
+    }
+    return ranges;
+}
+
+bool parseTxtFrameID(std::string_view line, int & frameID)
+{
+    const char * cur       = line.data();
+    const char * const end = cur + line.size();
+    for(int field = 0; field < 2; ++field) {
+        while(cur < end && isSeparator(*cur)) {
+            ++cur;
+        }
+        const char * fieldBegin = cur;
+        while(cur < end && !isSeparator(*cur)) {
+            ++cur;
+        }
+        if(cur == fieldBegin) {
+            return false;
+        }
+        if(field == 1) {
+            return toNumber(std::string_view(fieldBegin, cur - fieldBegin), frameID);
+        }
+    }
+    return false;
+}
+
+bool parseTxtRecord(std::string_view line, TxtRecord & record)
+{
+    constexpr size_t maxFields = 9;
+    std::array<std::string_view, maxFields> fields{};
+    size_t numFields = 0;
+
+    const char * cur       = line.data();
+    const char * const end = cur + line.size();
+    while(cur < end) {
+        while(cur < end && isSeparator(*cur)) {
+            ++cur;
+        }
+        if(cur == end) {
+            break;
+        }
+        const char * fieldBegin = cur;
+        while(cur < end && !isSeparator(*cur)) {
+            ++cur;
+        }
+        if(numFields < maxFields) {
+            fields[numFields] = std::string_view(fieldBegin, cur - fieldBegin);
+        }
+        ++numFields;
+    }
+
+    if(numFields != 5 && numFields < maxFields) {
+        return false;
+    }
+
+    int agentID = -1;
+    glm::dvec3 pos{};
+    glm::dvec3 radius      = {0.3 * FAKTOR, 0.3 * FAKTOR, 0.3 * FAKTOR};
+    glm::dvec3 orientation = {0, 0, 30};
+    double color           = 155;
+
+    bool ok = toNumber(fields[0], agentID) && toNumber(fields[1], record.frameID) &&
+              toNumber(fields[2], pos[0]) && toNumber(fields[3], pos[1]) &&
+              toNumber(fields[4], pos[2]);
+    if(ok && numFields >= maxFields) {
+        ok = toNumber(fields[5], radius[0]) && toNumber(fields[6], radius[1]) &&
+             toNumber(fields[7], orientation[2]) && toNumber(fields[8], color);
+        radius[0] *= FAKTOR;
+        radius[1] *= FAKTOR;
+    }
+    if(!ok) {
+        return false;
+    }
+    pos[0] *= FAKTOR;
+    pos[1] *= FAKTOR;
+    pos[2] *= FAKTOR;
+    record.element = FrameElement{pos, radius, orientation, color, agentID - 1};
+    return true;
+}
+
+template <>
+bool parseTxtRecord<TxtLayout::Kind::POSITIONS>(std::string_view line, TxtRecord & record)
+{
+    RecordValues values{};
+    if(!readFields(line, values.agentID, record.frameID, values.x, values.y, values.z)) {
+        return false;
+    }
+    storeRecord(values, record);
+    return true;
+}
+
+template <>
+bool parseTxtRecord<TxtLayout::Kind::ELLIPSES>(std::string_view line, TxtRecord & record)
+{
+    RecordValues values{};
+    if(!readFields(
+           line,
+           values.agentID,
+           record.frameID,
+           values.x,
+           values.y,
+           values.z,
+           values.a,
+           values.b,
+           values.angle,
+           values.color)) {
+        return false;
+    }
+    storeRecord(values, record);
+    return true;
+}
+
+bool parseTxtRecord(std::string_view line, const TxtLayout & layout, TxtRecord & record)
+{
+    RecordValues values{};
+    const char * cur       = line.data();
+    const char * const end = cur + line.size();
+    std::string_view field{};
+    for(const auto column : layout.columns) {
+        if(!nextField(cur, end, field)) {
+            return false;
+        }
+        bool ok{true};
+        switch(column) {
+            case TxtColumn::ID:
+                ok = toField(field, values.agentID);
+                break;
+            case TxtColumn::FR:
+                ok = toField(field, record.frameID);
+                break;
+            case TxtColumn::X:
+                ok = toField(field, values.x);
+                break;
+            case TxtColumn::Y:
+                ok = toField(field, values.y);
+                break;
+            case TxtColumn::Z:
+                ok = toField(field, values.z);
+                break;
+            case TxtColumn::A:
+                ok = toField(field, values.a);
+                break;
+            case TxtColumn::B:
+                ok = toField(field, values.b);
+                break;
+            case TxtColumn::ANGLE:
+                ok = toField(field, values.angle);
+                break;
+            case TxtColumn::COLOR:
+                ok = toField(field, values.color);
+                break;
+            case TxtColumn::OTHER:
+                break;
+        }
+        if(!ok) {
+            return false;
+        }
+    }
+    storeRecord(values, record);
+    return true;
+}
+
+TxtLayout parseTxtLayout(std::string_view line)
+{
+    if(line.empty() || line.front() != '#') {
+        return {};
+    }
+    line.remove_prefix(1);
+    TxtLayout layout{};
+    const char * cur       = line.data();
+    const char * const end = cur + line.size();
+    std::string_view field{};
+    while(nextField(cur, end, field)) {
+        layout.columns.push_back(columnNamed(field));
+    }
+
+    const auto has = [&layout](TxtColumn column) {
+        return std::find(layout.columns.begin(), layout.columns.end(), column) !=
+               layout.columns.end();
+    };
+    // the frame ids are read from the second field, see parseTxtFrameID()
+    if(layout.columns.size() < 5 || layout.columns[0] != TxtColumn::ID ||
+       layout.columns[1] != TxtColumn::FR || !has(TxtColumn::X) || !has(TxtColumn::Y) ||
+       !has(TxtColumn::Z)) {
+        return {};
+    }
+
+    using C = TxtColumn;
+
+    const std::vector<TxtColumn> positions = {C::ID, C::FR, C::X, C::Y, C::Z};
+    const std::vector<TxtColumn> ellipses  = {
+        C::ID, C::FR, C::X, C::Y, C::Z, C::A, C::B, C::ANGLE, C::COLOR};
+    if(layout.columns == positions) {
+        layout.kind = TxtLayout::Kind::POSITIONS;
+    } else if(layout.columns == ellipses) {
+        layout.kind = TxtLayout::Kind::ELLIPSES;
+    } else {
+        layout.kind = TxtLayout::Kind::GENERIC;
+    }
+    return layout;
+}
+} // namespace Parsing
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "FrameElement.h"
+
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+/// Low level parsing of the jpscore trajectory txt format.
+/// The functions in here work directly on the raw bytes of a file, e.g. a memory mapped file, and
+/// do not allocate per line. Numbers are converted with std::from_chars and are therefore
+/// independent of the current locale.
+namespace Parsing
+{
+/// Meaning of a column of the data section of a trajectory txt file
+enum class TxtColumn { ID, FR, X, Y, Z, A, B, ANGLE, COLOR, OTHER };
+
+/// Column layout of the data section, as declared by the header line naming the columns, e.g.
+/// '#ID FR X Y Z A B ANGLE COLOR'
+struct TxtLayout {
+    enum class Kind {
+        /// No layout declared, the layout of each line is detected from its number of fields
+        UNKNOWN,
+        /// ID FR X Y Z
+        POSITIONS,
+        /// ID FR X Y Z A B ANGLE COLOR
+        ELLIPSES,
+        /// ID FR followed by X Y Z and optionally A B ANGLE COLOR in any order, with additional
+        /// columns that are skipped
+        GENERIC
+    };
+    Kind kind{Kind::UNKNOWN};
+    /// Meaning of each column, empty for UNKNOWN
+    std::vector<TxtColumn> columns{};
+};
+
+/// Information found in the '#' prefixed header of a trajectory txt file.
+struct TxtHeader {
+    /// Frame rate as stated in the header, if present
+    std::optional<double> fps{};
+    /// Layout of the data lines, from the last header line naming the columns
+    TxtLayout layout{};
+    /// Offset in bytes of the first line after the header
+    size_t dataOffset{0};
+    /// Number of lines that belong to the header (including empty lines)
+    size_t lineCount{0};
+};
+
+/// A single line of the data section of a trajectory txt file.
+struct TxtRecord {
+    int frameID{-1};
+    FrameElement element{};
+};
+
+/// Reads the header of a trajectory txt file. The header ends with the first line that is neither
+/// empty nor starts with '#'.
+/// @param data bytes of the file starting at the beginning of the file
+/// @return TxtHeader found
+TxtHeader parseTxtHeader(std::string_view data);
+
+/// Parses a single data line. Fields are separated by tabs or blanks, empty fields are ignored.
+/// Lines with 5 fields (ID FR X Y Z) and with 9 or more fields (ID FR X Y Z A B ANGLE COLOR) are
+/// accepted, lengths are converted to cm.
+/// @param line to parse, without the line break
+/// @param record receives the parsed values
+/// @return true if the line is a valid record, false otherwise
+bool parseTxtRecord(std::string_view line, TxtRecord & record);
+
+/// Parses a single data line of a file with a known layout. The fields are converted in the order
+/// of the columns, there is no decision on the layout per line. Fields beyond the columns of the
+/// layout are not read.
+/// @tparam Kind either TxtLayout::Kind::POSITIONS or TxtLayout::Kind::ELLIPSES
+/// @param line to parse, without the line break
+/// @param record receives the parsed values
+/// @return true if the line is a valid record, false otherwise
+template <TxtLayout::Kind Kind>
+bool parseTxtRecord(std::string_view line, TxtRecord & record);
+
+template <>
+bool parseTxtRecord<TxtLayout::Kind::POSITIONS>(std::string_view line, TxtRecord & record);
+
+template <>
+bool parseTxtRecord<TxtLayout::Kind::ELLIPSES>(std::string_view line, TxtRecord & record);
+
+/// Parses a single data line according to an arbitrary layout, columns not known are skipped.
+/// @param line to parse, without the line break
+/// @param layout of the line, see parseTxtLayout()
+/// @param record receives the parsed values
+/// @return true if the line is a valid record, false otherwise
+bool parseTxtRecord(std::string_view line, const TxtLayout & layout, TxtRecord & record);
+
+/// Reads the layout from a header line naming the columns
+/// @param line of the header, including the leading '#'
+/// @return the layout, of kind UNKNOWN if 'line' does not name the columns starting with ID FR
+TxtLayout parseTxtLayout(std::string_view line);
+
+/// Calls 'func' once with the parser of data lines matching 'layout'. The parser is a callable
+/// with signature bool(std::string_view line, TxtRecord & record) whose type depends on the kind
+/// of the layout, so the loop over the lines in 'func' is compiled for each layout.
+/// @param layout of the data lines
+/// @param func generic callable taking the parser
+/// @return the result of 'func'
+template <typename Func>
+decltype(auto) withTxtRecordParser(const TxtLayout & layout, Func && func)
+{
+    switch(layout.kind) {
+        case TxtLayout::Kind::POSITIONS:
+            return func([](std::string_view line, TxtRecord & record) {
+                return parseTxtRecord<TxtLayout::Kind::POSITIONS>(line, record);
+            });
+        case TxtLayout::Kind::ELLIPSES:
+            return func([](std::string_view line, TxtRecord & record) {
+                return parseTxtRecord<TxtLayout::Kind::ELLIPSES>(line, record);
+            });
+        case TxtLayout::Kind::GENERIC:
+            return func([&layout](std::string_view line, TxtRecord & record) {
+                return parseTxtRecord(line, layout, record);
+            });
+        case TxtLayout::Kind::UNKNOWN:
+            break;
+    }
+    return func([](std::string_view line, TxtRecord & record) {
+        return parseTxtRecord(line, record);
+    });
+}
+
+/// Reads only the frame id of a data line, i.e. the second field. This is much cheaper than
+/// parseTxtRecord() and is used to index the frames of a file.
+/// @param line to parse, without the line break
+/// @param frameID receives the frame id
+/// @return true if the line has a valid frame id, the other fields are not validated
+bool parseTxtFrameID(std::string_view line, int & frameID);
+
+/// Splits 'data' into at most 'count' consecutive ranges of roughly equal size. Each range ends
+/// directly after a line break (or at the end of 'data') so that no line is split. Ranges may be
+/// fewer than requested if 'data' contains only few lines.
+/// @param data to split
+/// @param count of ranges requested, needs to be at least 1
+/// @return ranges covering 'data' completely and in order
+std::vector<std::string_view> splitAtLineBoundaries(std::string_view data, size_t count);
+
+/// Calls 'func' with every line in 'data'. Line breaks ('\n' as well as '\r\n') are not part of
+/// the line passed to 'func'. A last line without line break is passed as well.
+/// @param data to split into lines
+/// @param func callable with signature void(std::string_view)
+template <typename Func>
+void forEachLine(std::string_view data, Func && func)
+{
+    const char * cur       = data.data();
+    const char * const end = cur + data.size();
+    while(cur < end) {
+        const auto * eol  = static_cast<const char *>(memchr(cur, '\n', end - cur));
+        const char * next = eol ? eol + 1 : end;
+        const char * last = eol ? eol : end;
+        if(last > cur && *(last - 1) == '\r') {
+            --last;
+        }
+        func(std::string_view(cur, last - cur));
+        cur = next;
+    }
+}
+} // namespace Parsing
@@ -0,0 +1,292 @@
+#include "TxtStreamParser.h"
+
+#include "FrameBlock.h"
+#include "Log.h"
+#include "TrajectoryData.h"
+#include "TxtParsing.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <utility>
+
+/// Record as kept between parsing and bucketing, in the precision of the FrameBlock columns to
+/// keep the arena small
+struct TxtChunkRecord {
+    int frameID;
+    FrameBlock::Row row;
+};
+
+/// Result of parsing one line aligned chunk of the data section of a trajectory txt file.
+struct TxtChunkResult {
+    /// Records of this chunk in order of appearance
+    std::vector<TxtChunkRecord> records{};
+    /// Lines that could not be parsed as (chunk local line index, line)
+    std::vector<std::pair<size_t, std::string_view>> malformedLines{};
+    /// Number of lines in this chunk
+    size_t lineCount{0};
+};
+
+/// Parses all records in 'chunk' into a flat chunk local array.
+/// @param chunk of the data section, needs to start at a line boundary
+/// @param parseRecord parser of a data line, see Parsing::withTxtRecordParser()
+/// @return the parsed records
+template <typename Parser>
+static TxtChunkResult parseTxtChunk(std::string_view chunk, Parser parseRecord)
+{
+    TxtChunkResult result{};
+    // one record per line at most, counting the lines is cheap compared to parsing them
+    result.records.reserve(std::count(chunk.begin(), chunk.end(), '\n') + 1);
+    Parsing::TxtRecord record{};
+    Parsing::forEachLine(chunk, [&result, &record, &parseRecord](std::string_view line) {
+        const auto lineIndex = result.lineCount++;
+        if(!parseRecord(line, record)) {
+            result.malformedLines.emplace_back(lineIndex, line);
+            return;
+        }
+        result.records.push_back({record.frameID, FrameBlock::Row::from(record.element)});
+    });
+    return result;
+}
+
+/// Maps the frame ids of the records of one piece to consecutive slots in increasing id order.
+/// Frame ids are usually dense, the slot is the offset to the least id then. Sparse ids, e.g. of
+/// a file with only every 100th frame, are looked up in the sorted distinct ids instead of
+/// counting over the whole range of ids.
+class FrameSlots
+{
+    int _minFrame;
+    size_t _count;
+    /// Distinct frame ids in increasing order, empty if the ids are dense
+    std::vector<int> _frames{};
+
+public:
+    /// Slots for all ids in [minFrame, maxFrame]
+    FrameSlots(int minFrame, int maxFrame) :
+        _minFrame(minFrame), _count(static_cast<size_t>(int64_t{maxFrame} - minFrame + 1))
+    {
+    }
+
+    /// Slots for the ids in 'frames'
+    /// @param frames ids of all records, duplicates are removed
+    explicit FrameSlots(std::vector<int> && frames) : _frames(std::move(frames))
+    {
+        std::sort(_frames.begin(), _frames.end());
+        _frames.erase(std::unique(_frames.begin(), _frames.end()), _frames.end());
+        _minFrame = _frames.front();
+        _count    = _frames.size();
+    }
+
+    /// @return number of slots
+    size_t size() const { return _count; }
+
+    /// @return slot of 'frameID'
+    size_t slot(int frameID) const
+    {
+        if(_frames.empty()) {
+            return static_cast<size_t>(int64_t{frameID} - _minFrame);
+        }
+        const auto frame = std::lower_bound(_frames.begin(), _frames.end(), frameID);
+        return static_cast<size_t>(frame - _frames.begin());
+    }
+
+    /// @return frame id of 'slot'
+    int frameID(size_t slot) const
+    {
+        if(_frames.empty()) {
+            return static_cast<int>(_minFrame + static_cast<int64_t>(slot));
+        }
+        return _frames[slot];
+    }
+};
+
+namespace Parsing
+{
+TxtStreamParser::TxtStreamParser(
+    TrajectoryData * trajectories,
+    unsigned int numThreads,
+    size_t firstLine,
+    TxtLayout layout) :
+    _trajectories(trajectories),
+    _numThreads(numThreads == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : numThreads),
+    _lineCount(firstLine),
+    _layout(std::move(layout))
+{
+}
+
+void TxtStreamParser::feed(std::string_view data)
+{
+    // Split the data in line aligned chunks and parse each on its own thread into a thread local
+    // frame bucket. Chunks need to have a minimal size, otherwise starting the threads costs more
+    // than parsing.
+    constexpr size_t minChunkSize = 1 << 16;
+    const auto numChunks =
+        std::clamp<size_t>(data.size() / minChunkSize, 1, static_cast<size_t>(_numThreads));
+    const auto chunks = splitAtLineBoundaries(data, numChunks);
+    std::vector<TxtChunkResult> results(chunks.size());
+    std::vector<std::thread> workers{};
+    workers.reserve(chunks.size());
+    // the layout is dispatched once per piece, each chunk runs the parser matching the layout
+    withTxtRecordParser(_layout, [&results, &chunks, &workers](auto parseRecord) {
+        for(size_t i = 1; i < chunks.size(); ++i) {
+            workers.emplace_back([&results, &chunks, i, parseRecord]() {
+                results[i] = parseTxtChunk(chunks[i], parseRecord);
+            });
+        }
+        if(!chunks.empty()) {
+            results[0] = parseTxtChunk(chunks[0], parseRecord);
+        }
+        for(auto & worker : workers) {
+            worker.join();
+        }
+    });
+
+    // Bucket the records by frame with a counting sort: count the records of each frame, turn the
+    // counts into offsets with a prefix sum and scatter the elements to their offsets in a single
+    // buffer. The records are visited in file order, starting with the frame held back from the
+    // last piece, which keeps the elements of each frame in file order and yields the same frames
+    // as parsing the whole data serially.
+    const auto isPublished = [this](int frameID) {
+        return _lastPublishedFrame && frameID <= _lastPublishedFrame.value();
+    };
+    size_t recordCount = _pending.size();
+    int minFrame       = _pendingFrame.value_or(std::numeric_limits<int>::max());
+    int maxFrame       = _pendingFrame.value_or(std::numeric_limits<int>::min());
+    for(const auto & result : results) {
+        for(const auto & [lineIndex, line] : result.malformedLines) {
+            Log::Error(
+                "Malformed input, skipping line %zu:%s",
+                _lineCount + lineIndex + 1,
+                std::string(line.substr(0, 200)).c_str());
+        }
+        _lineCount += result.lineCount;
+        for(const auto & record : result.records) {
+            if(isPublished(record.frameID)) {
+                ++_droppedRecords;
+                continue;
+            }
+            ++recordCount;
+            minFrame = std::min(minFrame, record.frameID);
+            maxFrame = std::max(maxFrame, record.frameID);
+        }
+    }
+    if(recordCount == 0) {
+        return;
+    }
+
+    // at most two slots per record, sparser ids are looked up instead
+    const bool dense = int64_t{maxFrame} - minFrame < 2 * static_cast<int64_t>(recordCount);
+    const auto slots = [&]() {
+        if(dense) {
+            return FrameSlots(minFrame, maxFrame);
+        }
+        std::vector<int> frames{};
+        frames.reserve(recordCount);
+        if(_pendingFrame) {
+            frames.push_back(_pendingFrame.value());
+        }
+        for(const auto & result : results) {
+            for(const auto & record : result.records) {
+                if(!isPublished(record.frameID)) {
+                    frames.push_back(record.frameID);
+                }
+            }
+        }
+        return FrameSlots(std::move(frames));
+    }();
+
+    std::vector<size_t> offsets(slots.size() + 1, 0);
+    if(_pendingFrame) {
+        offsets[slots.slot(_pendingFrame.value()) + 1] += _pending.size();
+    }
+    for(const auto & result : results) {
+        for(const auto & record : result.records) {
+            if(!isPublished(record.frameID)) {
+                ++offsets[slots.slot(record.frameID) + 1];
+            }
+        }
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    std::vector<FrameBlock::Row> rows(recordCount);
+    std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+    if(_pendingFrame) {
+        auto & pendingNext = next[slots.slot(_pendingFrame.value())];
+        std::copy(_pending.begin(), _pending.end(), rows.begin() + pendingNext);
+        pendingNext += _pending.size();
+    }
+    for(auto & result : results) {
+        for(const auto & record : result.records) {
+            if(!isPublished(record.frameID)) {
+                rows[next[slots.slot(record.frameID)]++] = record.row;
+            }
+        }
+        // the records are not needed anymore, release them before the frames are converted
+        result.records = {};
+    }
+
+    // publish all frames but the last one, it might be continued in the next piece
+    const size_t lastSlot = slots.size() - 1;
+    size_t frameCount{0};
+    for(size_t slot = 0; slot < lastSlot; ++slot) {
+        frameCount += offsets[slot + 1] > offsets[slot];
+    }
+    if(frameCount > 0) {
+        auto block = std::make_shared<FrameBlock>();
+        block->reserve(frameCount, offsets[lastSlot]);
+        for(size_t slot = 0; slot < lastSlot; ++slot) {
+            if(offsets[slot + 1] > offsets[slot]) {
+                block->appendFrame(&rows[offsets[slot]], offsets[slot + 1] - offsets[slot]);
+                _lastPublishedFrame = slots.frameID(slot);
+            }
+        }
+        _trajectories->append(std::move(block));
+    }
+    _pending.assign(rows.begin() + offsets[lastSlot], rows.end());
+    _pendingFrame = maxFrame;
+}
+
+void TxtStreamParser::flush()
+{
+    publishPending();
+}
+
+void TxtStreamParser::finish()
+{
+    flush();
+    if(_droppedRecords > 0) {
+        Log::Warning(
+            "Trajectory data is not ordered by frame, dropped %zu records of already published "
+            "frames",
+            _droppedRecords);
+    }
+}
+
+bool TxtStreamParser::isOrdered() const
+{
+    return _droppedRecords == 0;
+}
+
+size_t TxtStreamParser::lineCount() const
+{
+    return _lineCount;
+}
+
+void TxtStreamParser::publishPending()
+{
+    if(!_pendingFrame) {
+        return;
+    }
+    auto block = std::make_shared<FrameBlock>();
+    block->reserve(1, _pending.size());
+    block->appendFrame(_pending.data(), _pending.size());
+    _lastPublishedFrame = _pendingFrame;
+    _pending.clear();
+    _pendingFrame.reset();
+    _trajectories->append(std::move(block));
+}
+} // namespace Parsing
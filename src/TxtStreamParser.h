@@ -0,0 +1,70 @@
+#pragma once
+
+#include "FrameBlock.h"
+#include "TxtParsing.h"
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+class TrajectoryData;
+
+namespace Parsing
+{
+/// Parses the data section of a trajectory txt file piece by piece and publishes completed frames
+/// to a TrajectoryData.
+/// Each piece is split into line aligned chunks that are parsed concurrently into flat arrays of
+/// records. The records are then bucketed by frame with a counting sort into one contiguous
+/// buffer, so frame ids need neither be ordered nor dense within a piece. A frame is
+/// considered complete as soon as records of a later frame have been seen, i.e. the frame with the
+/// highest id seen so far is held back until more data is fed or finish() is called.
+/// jpscore writes trajectories ordered by frame. If a piece contains records of a frame that has
+/// already been published, these records are dropped and isOrdered() returns false. Feeding all
+/// data in a single piece never drops records.
+class TxtStreamParser
+{
+    TrajectoryData * _trajectories;
+    unsigned int _numThreads;
+    size_t _lineCount;
+    TxtLayout _layout;
+    /// Elements of the frame held back, i.e. the frame with the highest id seen so far
+    std::vector<FrameBlock::Row> _pending{};
+    std::optional<int> _pendingFrame{};
+    std::optional<int> _lastPublishedFrame{};
+    size_t _droppedRecords{0};
+
+public:
+    /// Constructor
+    /// @param trajectories receives the completed frames
+    /// @param numThreads to use for parsing, 0 uses one thread per hardware thread
+    /// @param firstLine number of lines preceding the first piece, used for error messages
+    /// @param layout of the data lines as declared in the header, see TxtHeader::layout
+    TxtStreamParser(
+        TrajectoryData * trajectories,
+        unsigned int numThreads = 0,
+        size_t firstLine        = 0,
+        TxtLayout layout        = {});
+
+    /// Parses all lines in 'data' and publishes all frames that are complete afterwards.
+    /// @param data needs to start at a line boundary and to end with a complete line
+    void feed(std::string_view data);
+
+    /// Publishes the frame that has been held back without ending the stream, e.g. when no more
+    /// data is expected for a while. Records of this frame fed afterwards are dropped.
+    void flush();
+
+    /// Publishes the frame that has been held back. Call this once all data has been fed.
+    void finish();
+
+    /// @return false if records had to be dropped because their frame was already published
+    bool isOrdered() const;
+
+    /// @return number of lines parsed so far, including the lines preceding the first piece
+    size_t lineCount() const;
+
+private:
+    /// Publishes the held back frame
+    void publishPending();
+};
+} // namespace Parsing
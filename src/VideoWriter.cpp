@@ -0,0 +1,218 @@
+#include "VideoWriter.h"
+
+#include "Log.h"
+
+#include <QStringList>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPNGWriter.h>
+#include <vtkPointData.h>
+#include <vtkRenderWindow.h>
+#include <vtkWindowToImageFilter.h>
+
+namespace
+{
+/// Name of the encoder executable, looked up in PATH
+constexpr const char * ffmpeg = "ffmpeg";
+
+/// @return true if 'path' has the extension 'extension', ignoring the case
+bool hasExtension(const std::filesystem::path & path, std::string extension)
+{
+    auto actual = path.extension().string();
+    std::transform(actual.begin(), actual.end(), actual.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return actual == extension;
+}
+
+/// Runs ffmpeg with 'arguments' followed by options producing widely playable videos
+/// @param arguments input options
+/// @param output video file
+/// @param process to run ffmpeg in
+/// @return false if ffmpeg could not be started
+bool startEncoder(
+    QStringList arguments,
+    const std::filesystem::path & output,
+    QProcess & process)
+{
+    arguments.prepend("error");
+    arguments.prepend("-loglevel");
+    arguments.prepend("-y");
+    // most players only decode 4:2:0 chroma subsampling
+    arguments << "-pix_fmt"
+              << "yuv420p" << QString::fromStdString(output.string());
+    process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    process.start(ffmpeg, arguments);
+    if(!process.waitForStarted()) {
+        Log::Error("could not start <%s>, is it installed and in PATH?", ffmpeg);
+        return false;
+    }
+    return true;
+}
+
+/// Waits for the encoder to exit
+/// @return true if it succeeded
+bool finishEncoder(QProcess & process, const std::filesystem::path & output)
+{
+    process.waitForFinished(-1);
+    if(process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        Log::Error("could not encode <%s>", output.string().c_str());
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+VideoWriter::VideoWriter() :
+    _grabber(vtkSmartPointer<vtkWindowToImageFilter>::New()),
+    _pngWriter(vtkSmartPointer<vtkPNGWriter>::New())
+{
+    _grabber->SetInputBufferTypeToRGB();
+    // offscreen windows only have a back buffer, on screen the back buffer holds the last frame
+    _grabber->ReadFrontBufferOff();
+    _pngWriter->SetInputConnection(_grabber->GetOutputPort());
+}
+
+VideoWriter::~VideoWriter()
+{
+    Close();
+}
+
+bool VideoWriter::Open(const std::filesystem::path & output, int width, int height, double fps)
+{
+    Close();
+    _output        = output;
+    _width         = width;
+    _height        = height;
+    _frameCount    = 0;
+    _imageSequence = hasExtension(output, ".png");
+
+    std::error_code error;
+    if(output.has_parent_path()) {
+        std::filesystem::create_directories(output.parent_path(), error);
+    }
+
+    if(!_imageSequence) {
+        // VTK stores the rows bottom up, 4:2:0 subsampling needs an even width and height
+        QStringList arguments{
+            "-f",
+            "rawvideo",
+            "-pix_fmt",
+            "rgb24",
+            "-s",
+            QString("%1x%2").arg(width).arg(height),
+            "-r",
+            QString::number(fps),
+            "-i",
+            "-",
+            "-vf",
+            "vflip,pad=ceil(iw/2)*2:ceil(ih/2)*2"};
+        if(!startEncoder(arguments, output, _encoder)) {
+            return false;
+        }
+    }
+    Log::Info("recording %dx%d frames to <%s>", width, height, output.string().c_str());
+    _open = true;
+    return true;
+}
+
+bool VideoWriter::Write(vtkRenderWindow * window)
+{
+    if(!_open) {
+        return false;
+    }
+    const int * size = window->GetSize();
+    if(size[0] != _width || size[1] != _height) {
+        Log::Warning(
+            "skipping frame of %dx%d pixels, recording %dx%d", size[0], size[1], _width, _height);
+        return false;
+    }
+    _grabber->SetInput(window);
+    _grabber->Modified();
+
+    if(_imageSequence) {
+        char number[16];
+        snprintf(number, sizeof(number), "_%07d.png", _frameCount);
+        const auto fileName = _output.parent_path() / (_output.stem().string() + number);
+        _pngWriter->SetFileName(fileName.string().c_str());
+        _pngWriter->Write();
+        ++_frameCount;
+        return true;
+    }
+
+    _grabber->Update();
+    auto * pixels      = _grabber->GetOutput()->GetPointData()->GetScalars();
+    const qint64 bytes = static_cast<qint64>(_width) * _height * 3;
+    _encoder.write(static_cast<const char *>(pixels->GetVoidPointer(0)), bytes);
+    // bound the memory held by the pipe buffer to a frame, the encoder sets the pace
+    while(_encoder.bytesToWrite() > 0) {
+        if(!_encoder.waitForBytesWritten(-1)) {
+            Log::Error(
+                "encoder stopped accepting frames: %s", qUtf8Printable(_encoder.errorString()));
+            return false;
+        }
+    }
+    ++_frameCount;
+    return true;
+}
+
+bool VideoWriter::Close()
+{
+    if(!_open) {
+        return true;
+    }
+    _open = false;
+    bool success{true};
+    if(!_imageSequence) {
+        _encoder.closeWriteChannel();
+        success = finishEncoder(_encoder, _output);
+    }
+    Log::Info("recorded %d frames to <%s>", _frameCount, _output.string().c_str());
+    return success;
+}
+
+bool VideoWriter::IsOpen() const
+{
+    return _open;
+}
+
+int VideoWriter::FrameCount() const
+{
+    return _frameCount;
+}
+
+bool VideoWriter::EncodeImageSequence(
+    const std::filesystem::path & firstImage,
+    const std::filesystem::path & output,
+    double fps)
+{
+    // "tmp_0000042.png" is read as "tmp_%07d.png" starting at 42
+    const auto stem   = firstImage.stem().string();
+    const auto digits = stem.size() - (stem.find_last_not_of("0123456789") + 1);
+    if(digits == 0) {
+        Log::Error("<%s> is not part of a numbered sequence", firstImage.string().c_str());
+        return false;
+    }
+    const auto prefix     = stem.substr(0, stem.size() - digits);
+    const auto startIndex = stem.substr(stem.size() - digits);
+    const auto pattern    = firstImage.parent_path() /
+                         (prefix + "%0" + std::to_string(digits) + "d" +
+                          firstImage.extension().string());
+
+    QStringList arguments{
+        "-framerate",
+        QString::number(fps),
+        "-start_number",
+        QString::fromStdString(startIndex),
+        "-i",
+        QString::fromStdString(pattern.string())};
+    QProcess encoder;
+    if(!startEncoder(arguments, output, encoder)) {
+        return false;
+    }
+    encoder.closeWriteChannel();
+    return finishEncoder(encoder, output);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QProcess>
+#include <filesystem>
+#include <vtkSmartPointer.h>
+
+class vtkPNGWriter;
+class vtkRenderWindow;
+class vtkWindowToImageFilter;
+
+/// Writes the frames rendered into a render window to a video or an image sequence.
+/// Videos are encoded by a local ffmpeg process, the pixels of every frame are streamed to its
+/// standard input as raw RGB. The container and codec are chosen by ffmpeg from the extension of
+/// the output file. Outputs ending in ".png" are written as numbered PNG images instead, e.g.
+/// "out.png" becomes "out_0000000.png", "out_0000001.png", ... which needs no encoder at all.
+/// All frames need to have the size passed to Open().
+class VideoWriter
+{
+    vtkSmartPointer<vtkWindowToImageFilter> _grabber;
+    vtkSmartPointer<vtkPNGWriter> _pngWriter;
+    QProcess _encoder{};
+    std::filesystem::path _output{};
+    bool _open{false};
+    bool _imageSequence{false};
+    int _width{0};
+    int _height{0};
+    int _frameCount{0};
+
+public:
+    VideoWriter();
+    ~VideoWriter();
+
+    VideoWriter(const VideoWriter &) = delete;
+    VideoWriter & operator=(const VideoWriter &) = delete;
+
+    /// Starts a new output, an open one is closed first
+    /// @param output video file, or first image of the sequence if it ends in ".png"
+    /// @param width of the frames in pixels
+    /// @param height of the frames in pixels
+    /// @param fps frame rate of the video
+    /// @return false if the encoder could not be started
+    bool Open(const std::filesystem::path & output, int width, int height, double fps);
+
+    /// Appends the content of 'window' as the next frame
+    /// @param window to read the pixels from, rendered with the size passed to Open()
+    /// @return false if the frame could not be written
+    bool Write(vtkRenderWindow * window);
+
+    /// Finishes the output and waits for the encoder
+    /// @return false if the encoder failed
+    bool Close();
+
+    /// @return true between Open() and Close()
+    bool IsOpen() const;
+
+    /// @return number of frames written since Open()
+    int FrameCount() const;
+
+    /// Encodes an existing image sequence into a video with ffmpeg
+    /// @param firstImage of the sequence, its name needs to end with the number of the image
+    /// @param output video file
+    /// @param fps frame rate of the video
+    /// @return false if the sequence could not be encoded
+    static bool EncodeImageSequence(
+        const std::filesystem::path & firstImage,
+        const std::filesystem::path & output,
+        double fps);
+};
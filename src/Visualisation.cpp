@@ -35,21 +35,25 @@
 
 #include "Frame.h"
 #include "FrameElement.h"
+#include "FrameModel.h"
 #include "InteractorStyle.h"
 #include "Log.h"
+#include "TemporalPyramid.h"
 #include "TrajectoryPoint.h"
 #include "general/Macros.h"
 #include "geometry/FacilityGeometry.h"
 #include "geometry/GeometryFactory.h"
 #include "geometry/LinePlotter2D.h"
 #include "geometry/Point.h"
-#include "geometry/PointPlotter.h"
 
 #include <MainWindow.h>
 #include <QMessageBox>
 #include <QObject>
 #include <QString>
 #include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <vtkActor.h>
 #include <vtkActor2DCollection.h>
 #include <vtkAssembly.h>
@@ -62,8 +66,8 @@
 #include <vtkDiskSource.h>
 #include <vtkFileOutputWindow.h>
 #include <vtkFloatArray.h>
+#include <vtkGlyph3DMapper.h>
 #include <vtkInteractorStyleTrackballCamera.h>
-#include <vtkLabeledDataMapper.h>
 #include <vtkLight.h>
 #include <vtkLightKit.h>
 #include <vtkLine.h>
@@ -84,7 +88,61 @@
 #include <vtkTextActor.h>
 #include <vtkTextProperty.h>
 #include <vtkTriangleFilter.h>
-#include <vtkWindowToImageFilter.h>
+
+namespace
+{
+/// Radius of a typical agent in world units, used to estimate the size of agents on screen
+constexpr double typicalAgentRadius = 25;
+/// Diameter of the density splats in pixels
+constexpr double densitySplatPixels = 2;
+/// Circumferential resolution of the agent glyphs at LodTier::FULL and LodTier::LOW_POLY
+constexpr int fullResolution    = 20;
+constexpr int lowPolyResolution = 6;
+
+/// Draws the sprites of vtkPointGaussianMapper as flat discs instead of gaussian blobs
+constexpr const char * discSplatShader =
+    "//VTK::Color::Impl\n"
+    "if(dot(offsetVCVSOutput.xy, offsetVCVSOutput.xy) > 1.0) {\n"
+    "  discard;\n"
+    "}\n";
+
+/// Creates a mapper that draws the glyph 'source' instanced at every agent of 'agents', using the
+/// "scales" and "orientations" arrays written by FrameModel. Only these per agent arrays are
+/// uploaded for a new frame. If the OpenGL implementation does not support instancing, e.g. an
+/// old Mesa, VTK falls back to drawing the glyphs one by one.
+/// @param source glyph geometry
+/// @param agents points of the agents
+/// @return the mapper
+vtkSmartPointer<vtkGlyph3DMapper>
+createInstancedMapper(vtkAlgorithmOutput * source, vtkPolyData * agents)
+{
+    auto mapper = vtkSmartPointer<vtkGlyph3DMapper>::New();
+    mapper->SetSourceConnection(source);
+    mapper->SetInputData(agents);
+    mapper->ScalingOn();
+    mapper->SetScaleModeToScaleByVectorComponents();
+    mapper->SetScaleArray("scales");
+    mapper->OrientOn();
+    mapper->SetOrientationModeToRotation();
+    mapper->SetOrientationArray("orientations");
+    return mapper;
+}
+
+/// Creates a mapper that draws every agent of 'agents' as a sprite
+/// @param agents points of the agents
+/// @param lut to map the colors of the agents
+/// @return the mapper
+vtkSmartPointer<vtkPointGaussianMapper>
+createSpritesMapper(vtkPolyData * agents, vtkLookupTable * lut)
+{
+    auto mapper = vtkSmartPointer<vtkPointGaussianMapper>::New();
+    mapper->SetInputData(agents);
+    mapper->SetLookupTable(lut);
+    mapper->SetScaleFactor(typicalAgentRadius);
+    mapper->SetSplatShaderCode(discSplatShader);
+    return mapper;
+}
+} // namespace
 
 Visualisation::Visualisation(
     QObject * parent,
@@ -96,7 +154,8 @@ Visualisation::Visualisation(
     _trajectories(trajectories),
     _renderWindow(renderWindow),
     _renderer(vtkRenderer::New()),
-    _runningTime(vtkTextActor::New())
+    _runningTime(vtkTextActor::New()),
+    _preparer(std::make_unique<FramePreparer>(*trajectories, _frame2D, _frame3D))
 {
     _renderWindow->AddRenderer(_renderer);
     _winTitle = "header without room caption";
@@ -111,13 +170,15 @@ void Visualisation::start()
 {
     _renderer->RemoveAllViewProps();
     _renderer->RemoveAllObservers();
+    // prepared frames may stem from the previous trajectory
+    _preparer->Invalidate();
     _geometry.Init(_renderer);
 
     initGlyphs2D();
     initGlyphs3D();
 
     // create the trails
-    _trail_plotter = std::make_unique<PointPlotter>();
+    _trail_plotter = std::make_unique<TrailPlotter>();
     _renderer->AddActor(_trail_plotter->getActor());
 
     // Create the render window
@@ -133,11 +194,13 @@ void Visualisation::start()
 
     _renderer->AddActor2D(_runningTime);
 
-    // Create an interactor
+    // Create an interactor, offscreen windows have none and are driven by calling onExecute()
     auto * interactor = _renderWindow->GetInteractor();
-    vtkNew<InteractorStyle> myStyle;
-    myStyle->SetVisualisation(this);
-    interactor->SetInteractorStyle(myStyle);
+    if(interactor != nullptr) {
+        vtkNew<InteractorStyle> myStyle;
+        myStyle->SetVisualisation(this);
+        interactor->SetInteractorStyle(myStyle);
+    }
 
     if(_settings->mode == RenderMode::MODE_2D) {
         _renderer->GetActiveCamera()->OrthogonalizeViewUp();
@@ -151,31 +214,35 @@ void Visualisation::start()
             reinterpret_cast<Visualisation *>(clientData)->onExecute();
         });
     _timer_cb->SetClientData(this);
-    if(_trajectories->getFrameCount() > 0) {
-        _timer_id = interactor->CreateRepeatingTimer(1000.0 / _trajectories->getFps());
+    // The timer is needed as soon as the frame rate is known, frames may still be loading.
+    // It ticks at the highest display rate, the clock decides when to present the next frame.
+    if(interactor != nullptr && _trajectories->getFps() > 0) {
+        _timer_id = interactor->CreateRepeatingTimer(1000.0 / PlaybackClock::MAX_DISPLAY_RATE);
     }
+    _clock.SetFps(_trajectories->getFps());
+    _clock.SetSpeed(_replay_speed);
     runningTime = _runningTime;
-    interactor->AddObserver(vtkCommand::TimerEvent, _timer_cb);
-
-
-    // create the necessary connections
-    QObject::connect(
-        this,
-        &Visualisation::signalFrameNumber,
-        dynamic_cast<MainWindow *>(this->parent()),
-        &MainWindow::slotFrameNumber);
-
-    QObject::connect(
-        this,
-        &Visualisation::signalMousePositionUpdated,
-        dynamic_cast<MainWindow *>(this->parent()),
-        &MainWindow::slotMousePositionUpdated);
+    if(interactor != nullptr) {
+        interactor->AddObserver(vtkCommand::TimerEvent, _timer_cb);
+    }
 
-    QObject::connect(
-        this,
-        &Visualisation::signalMaxFramesUpdated,
-        dynamic_cast<MainWindow *>(this->parent()),
-        &MainWindow::slotUpdateNumFrames);
+    // create the necessary connections, there is no main window when rendering offscreen
+    if(auto * mainWindow = dynamic_cast<MainWindow *>(this->parent())) {
+        QObject::connect(
+            this, &Visualisation::signalFrameNumber, mainWindow, &MainWindow::slotFrameNumber);
+
+        QObject::connect(
+            this,
+            &Visualisation::signalMousePositionUpdated,
+            mainWindow,
+            &MainWindow::slotMousePositionUpdated);
+
+        QObject::connect(
+            this,
+            &Visualisation::signalMaxFramesUpdated,
+            mainWindow,
+            &MainWindow::slotUpdateNumFrames);
+    }
 
     emit signalMaxFramesUpdated(_trajectories->getFrameCount());
 
@@ -197,60 +264,107 @@ void Visualisation::start()
     setWallsColor(_settings->wallsColor);
     setFloorColor(_settings->floorColor);
     setExitsColor(_settings->exitsColor);
+    setInstancedAgents(_settings->instancedAgents);
     _renderer->ResetCamera();
-    emit signalMaxFramesUpdated(_trajectories->getFrameCount());
+    _dirty             = DIRTY_ALL;
+    _lastFrameIndex    = -1;
+    _lastFraction      = 0;
+    _lastWindowSize[0] = 0;
+    _lastWindowSize[1] = 0;
+    _lastFrameCount    = _trajectories->getFrameCount();
+    emit signalMaxFramesUpdated(_lastFrameCount);
     emit signalFrameNumber(0);
     _renderWindow->Render();
 }
 
 void Visualisation::stop()
 {
-    QObject::disconnect(
-        this,
-        &Visualisation::signalFrameNumber,
-        dynamic_cast<MainWindow *>(this->parent()),
-        &MainWindow::slotFrameNumber);
-
-    QObject::disconnect(
-        this,
-        &Visualisation::signalMousePositionUpdated,
-        dynamic_cast<MainWindow *>(this->parent()),
-        &MainWindow::slotMousePositionUpdated);
-
-    QObject::disconnect(
-        this,
-        &Visualisation::signalMaxFramesUpdated,
-        dynamic_cast<MainWindow *>(this->parent()),
-        &MainWindow::slotUpdateNumFrames);
+    if(auto * mainWindow = dynamic_cast<MainWindow *>(this->parent())) {
+        QObject::disconnect(
+            this, &Visualisation::signalFrameNumber, mainWindow, &MainWindow::slotFrameNumber);
+
+        QObject::disconnect(
+            this,
+            &Visualisation::signalMousePositionUpdated,
+            mainWindow,
+            &MainWindow::slotMousePositionUpdated);
+
+        QObject::disconnect(
+            this,
+            &Visualisation::signalMaxFramesUpdated,
+            mainWindow,
+            &MainWindow::slotUpdateNumFrames);
+    }
 
+    stopRecording();
     _trail_plotter.reset();
-    _renderWindow->GetInteractor()->DestroyTimer(_timer_id);
-    _renderWindow->GetInteractor()->RemoveAllObservers();
+    if(auto * interactor = _renderWindow->GetInteractor()) {
+        interactor->DestroyTimer(_timer_id);
+        interactor->RemoveAllObservers();
+    }
+}
+
+void Visualisation::invalidate(unsigned parts)
+{
+    _dirty |= parts;
 }
 
-void Visualisation::update()
+void Visualisation::update(double position)
 {
-    auto polyData2D = _trajectories->currentFrame()->GetPolyData2D();
-    _glyphs_pedestrians->SetInputData(polyData2D);
-    _glyphs_pedestrians->Update();
-    _pedestrians_labels->GetMapper()->SetInputDataObject(polyData2D);
-    _pedestrians_labels->GetMapper()->Update();
-    _glyphs_directions->SetInputData(polyData2D);
-    _glyphs_directions->Update();
-    auto polyData3D = _trajectories->currentFrame()->GetPolyData3D();
-    _glyphs_pedestrians_3D->SetInputData(polyData3D);
-    _glyphs_pedestrians_3D->Update();
+    // The glyph filters are connected to the models in initGlyphs2D/3D, presenting a prepared
+    // buffer makes the pipeline pick up the new frame on the next render. Models that are not
+    // displayed are left untouched, they are brought up to date when the settings change.
+    if(!_settings->showAgents) {
+        return;
+    }
+    // the labels and directions are drawn from the 2D model in both modes
+    _preparer->SetModels(
+        _settings->mode == RenderMode::MODE_2D || _settings->showAgentsCaptions ||
+            _settings->showAgentDirections,
+        _settings->mode == RenderMode::MODE_3D);
+
+    // a prepared frame is good enough if it is off by less than half a presentation interval
+    const double advance   = _clock.ExpectedAdvance();
+    const double tolerance = _settings->interpolateFrames ? 0.5 * std::abs(advance) : 0;
+    _preparer->Present(position, tolerance);
+    if(!_clock.IsRunning()) {
+        return;
+    }
+
+    // prepare the frame expected next while this one is rendered
+    const double last = std::max(_trajectories->getFrameCount() - 1, 0);
+    const int level   = TemporalPyramid::levelForStride(std::abs(advance));
+    double next       = position + advance;
+    if(level > 0) {
+        // fast-forward, see onExecute()
+        next = TemporalPyramid::snapToLevel(static_cast<int>(std::clamp(next, 0.0, last)), level);
+    } else if(!_settings->interpolateFrames) {
+        // the next frame that differs from the current one
+        next = advance < 0 ? std::min(std::floor(next), std::floor(position) - 1) :
+                             std::max(std::floor(next), std::floor(position) + 1);
+    }
+    _preparer->Request(std::clamp(next, 0.0, last));
 }
+
 void Visualisation::renderFrame()
 {
-    // TODO(kkratz): Updating visibility from settings should probably be cached.
-    // TODO(kkratz): Updating visibility should be done from Update.
-    _glyphs_pedestrians_actor_2D->SetVisibility(_settings->mode == RenderMode::MODE_2D);
-    _glyphs_pedestrians_actor_3D->SetVisibility(_settings->mode == RenderMode::MODE_3D);
-    _pedestrians_labels->SetVisibility(_settings->showAgentsCaptions);
-    _glyphs_directions_actor->SetVisibility(_settings->showAgentDirections);
-    _trail_plotter->SetVisibility(_settings->showTrajectories);
-    _renderer->GetRenderWindow()->GetInteractor()->Render();
+    if(_dirty & DIRTY_SETTINGS) {
+        _glyphs_pedestrians_actor_2D->SetVisibility(
+            _settings->showAgents && _settings->mode == RenderMode::MODE_2D);
+        _glyphs_pedestrians_actor_3D->SetVisibility(
+            _settings->showAgents && _settings->mode == RenderMode::MODE_3D);
+        _pedestrians_labels->SetVisibility(_settings->showAgents && _settings->showAgentsCaptions);
+        _glyphs_directions_actor->SetVisibility(
+            _settings->showAgents && _settings->showAgentDirections &&
+            _lod.Tier() == LodTier::FULL);
+        _trail_plotter->SetVisibility(_settings->showTrajectories);
+    }
+    if(auto * interactor = _renderWindow->GetInteractor()) {
+        interactor->Render();
+    } else {
+        _renderWindow->Render();
+    }
+    _dirty = DIRTY_NONE;
 }
 
 void Visualisation::setGeometryVisibility(bool status)
@@ -260,76 +374,86 @@ void Visualisation::setGeometryVisibility(bool status)
     } else {
         _geometry.Set3D(status);
     }
+    _dirty |= DIRTY_SETTINGS;
 }
 void Visualisation::setTrainData(
     std::map<std::string, std::shared_ptr<TrainType>> && trainTypes,
     std::map<int, std::shared_ptr<TrainTimeTable>> && trainTimeTable)
 {
+    for(const auto & [id, tab] : _trainTimeTables) {
+        _renderer->RemoveActor(tab->actor);
+        _renderer->RemoveActor(tab->textActor);
+    }
     _trainTypes      = trainTypes;
     _trainTimeTables = trainTimeTable;
+    _dirty |= DIRTY_TRAINS;
 }
 
 /// show / hide the walls
 void Visualisation::showWalls(bool status)
 {
     _geometry.ShowWalls(status);
+    _dirty |= DIRTY_SETTINGS;
 }
 
 /// show/ hide the exits
 void Visualisation::showDoors(bool status)
 {
     _geometry.ShowDoors(status);
+    _dirty |= DIRTY_SETTINGS;
 }
 
 void Visualisation::showNavLines(bool status)
 {
     _geometry.ShowNavLines(status);
+    _dirty |= DIRTY_SETTINGS;
 }
 
 void Visualisation::showFloor(bool status)
 {
     _geometry.ShowFloor(status);
+    _dirty |= DIRTY_SETTINGS;
 }
 
 void Visualisation::showObstacle(bool status)
 {
     _geometry.ShowObstacles(status);
+    _dirty |= DIRTY_SETTINGS;
 }
 void Visualisation::showGradientField(bool status)
 {
     _geometry.ShowGradientField(status);
+    _dirty |= DIRTY_SETTINGS;
 }
 void Visualisation::initGlyphs2D()
 {
     _glyphs_pedestrians_actor_2D = vtkActor::New();
-    _pedestrians_labels          = vtkActor2D::New();
     _glyphs_directions           = vtkTensorGlyph::New();
     _glyphs_directions_actor     = vtkActor::New();
     _glyphs_pedestrians          = vtkTensorGlyph::New();
 
     // now create the glyphs with ellipses
-    VTK_CREATE(vtkDiskSource, agentShape);
-    agentShape->SetCircumferentialResolution(20);
-    agentShape->SetInnerRadius(0);
-    agentShape->SetOuterRadius(30);
+    _agentShape2D = vtkSmartPointer<vtkDiskSource>::New();
+    _agentShape2D->SetCircumferentialResolution(fullResolution);
+    _agentShape2D->SetInnerRadius(0);
+    _agentShape2D->SetOuterRadius(30);
 
     // speed the rendering using triangles stripers
     VTK_CREATE(vtkTriangleFilter, tris);
-    tris->SetInputConnection(agentShape->GetOutputPort());
+    tris->SetInputConnection(_agentShape2D->GetOutputPort());
 
     VTK_CREATE(vtkStripper, strip);
     strip->SetInputConnection(tris->GetOutputPort());
 
     _glyphs_pedestrians->SetSourceConnection(strip->GetOutputPort());
 
-    // first frame
-
-    _glyphs_pedestrians->SetInputConnection(agentShape->GetOutputPort());
+    // the agents of the current frame, updated in place
+    _glyphs_pedestrians->SetInputData(_frame2D.GetPolyData());
     _glyphs_pedestrians->ThreeGlyphsOff();
     _glyphs_pedestrians->ExtractEigenvaluesOff();
 
-    VTK_CREATE(vtkPolyDataMapper, mapper);
-    mapper->SetInputConnection(_glyphs_pedestrians->GetOutputPort());
+    _glyphs_pedestrians_mapper_2D = vtkSmartPointer<vtkPolyDataMapper>::New();
+    _glyphs_pedestrians_mapper_2D->SetInputConnection(_glyphs_pedestrians->GetOutputPort());
 
     VTK_CREATE(vtkLookupTable, lut);
     lut->SetHueRange(0.0, 0.470);
@@ -337,9 +461,14 @@ void Visualisation::initGlyphs2D()
     lut->SetNanColor(0.2, 0.2, 0.2, 0.5);
     lut->SetNumberOfTableValues(256);
     lut->Build();
-    mapper->SetLookupTable(lut);
+    _glyphs_pedestrians_mapper_2D->SetLookupTable(lut);
+
+    _instanced_pedestrians_mapper_2D =
+        createInstancedMapper(strip->GetOutputPort(), _frame2D.GetPolyData());
+    _instanced_pedestrians_mapper_2D->SetLookupTable(lut);
+    _sprites_mapper_2D = createSpritesMapper(_frame2D.GetPolyData(), lut);
 
-    _glyphs_pedestrians_actor_2D->SetMapper(mapper);
+    _glyphs_pedestrians_actor_2D->SetMapper(_glyphs_pedestrians_mapper_2D);
 
     _renderer->AddActor(_glyphs_pedestrians_actor_2D);
 
@@ -354,25 +483,28 @@ void Visualisation::initGlyphs2D()
     strip2->SetInputConnection(tris2->GetOutputPort());
 
     _glyphs_directions->SetSourceConnection(strip2->GetOutputPort());
-    _glyphs_directions->SetInputConnection(agentDirection->GetOutputPort());
+    _glyphs_directions->SetInputData(_frame2D.GetPolyData());
     _glyphs_directions->ThreeGlyphsOff();
     _glyphs_directions->ExtractEigenvaluesOff();
 
-    VTK_CREATE(vtkPolyDataMapper, mapper2);
-    mapper2->SetInputConnection(_glyphs_directions->GetOutputPort());
-    mapper2->ScalarVisibilityOff(); // to set color
-    mapper2->SetLookupTable(lut);
+    _glyphs_directions_mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+    _glyphs_directions_mapper->SetInputConnection(_glyphs_directions->GetOutputPort());
+    _glyphs_directions_mapper->ScalarVisibilityOff(); // to set color
+    _glyphs_directions_mapper->SetLookupTable(lut);
 
-    _glyphs_directions_actor->SetMapper(mapper2);
+    _instanced_directions_mapper =
+        createInstancedMapper(strip2->GetOutputPort(), _frame2D.GetPolyData());
+    _instanced_directions_mapper->ScalarVisibilityOff(); // to set color
+
+    _glyphs_directions_actor->SetMapper(_glyphs_directions_mapper);
     _glyphs_directions_actor->GetProperty()->SetColor(0, 0, 0); // black
     _renderer->AddActor2D(_glyphs_directions_actor);
 
-    // structure for the labels
-    VTK_CREATE(vtkLabeledDataMapper, labelMapper);
-    _pedestrians_labels->SetMapper(labelMapper);
-    labelMapper->SetFieldDataName("labels");
-    labelMapper->SetLabelModeToLabelFieldData();
-    _renderer->AddActor2D(_pedestrians_labels);
+    // structure for the labels, only the ids not overlapping each other on screen are placed
+    const double labelColor[3] = {1, 1, 1};
+    _pedestrians_labels = std::make_unique<LabelPlotter>(labelColor, 12);
+    _pedestrians_labels->SetInputData(_frame2D.GetPolyData(), "labels");
+    _renderer->AddActor2D(_pedestrians_labels->getActor());
     _pedestrians_labels->SetVisibility(false);
 }
 
@@ -382,25 +514,25 @@ void Visualisation::initGlyphs3D()
     _glyphs_pedestrians_actor_3D = vtkActor::New();
 
     // now create the glyphs with zylinders
-    VTK_CREATE(vtkCylinderSource, agentShape);
-    agentShape->SetHeight(160);
-    agentShape->SetRadius(20);
-    agentShape->SetResolution(20);
+    _agentShape3D = vtkSmartPointer<vtkCylinderSource>::New();
+    _agentShape3D->SetHeight(160);
+    _agentShape3D->SetRadius(20);
+    _agentShape3D->SetResolution(fullResolution);
 
     // speed the rendering using triangles stripers
     VTK_CREATE(vtkTriangleFilter, tris);
-    tris->SetInputConnection(agentShape->GetOutputPort());
+    tris->SetInputConnection(_agentShape3D->GetOutputPort());
 
     VTK_CREATE(vtkStripper, strip);
     strip->SetInputConnection(tris->GetOutputPort());
 
     _glyphs_pedestrians_3D->SetSourceConnection(strip->GetOutputPort());
-    _glyphs_pedestrians_3D->SetInputConnection(strip->GetOutputPort());
+    _glyphs_pedestrians_3D->SetInputData(_frame3D.GetPolyData());
     _glyphs_pedestrians_3D->ThreeGlyphsOff();
     _glyphs_pedestrians_3D->ExtractEigenvaluesOff();
 
-    VTK_CREATE(vtkPolyDataMapper, mapper);
-    mapper->SetInputConnection(_glyphs_pedestrians_3D->GetOutputPort());
+    _glyphs_pedestrians_mapper_3D = vtkSmartPointer<vtkPolyDataMapper>::New();
+    _glyphs_pedestrians_mapper_3D->SetInputConnection(_glyphs_pedestrians_3D->GetOutputPort());
 
     VTK_CREATE(vtkLookupTable, lut);
     lut->SetHueRange(0.0, 0.470);
@@ -408,15 +540,93 @@ void Visualisation::initGlyphs3D()
     lut->SetNanColor(0.2, 0.2, 0.2, 0.5);
     lut->SetNumberOfTableValues(256);
     lut->Build();
-    mapper->SetLookupTable(lut);
+    _glyphs_pedestrians_mapper_3D->SetLookupTable(lut);
 
-    _glyphs_pedestrians_actor_3D->SetMapper(mapper);
+    _instanced_pedestrians_mapper_3D =
+        createInstancedMapper(strip->GetOutputPort(), _frame3D.GetPolyData());
+    _instanced_pedestrians_mapper_3D->SetLookupTable(lut);
+    _sprites_mapper_3D = createSpritesMapper(_frame3D.GetPolyData(), lut);
+
+    _glyphs_pedestrians_actor_3D->SetMapper(_glyphs_pedestrians_mapper_3D);
     _glyphs_pedestrians_actor_3D->GetProperty()->BackfaceCullingOn();
     _renderer->AddActor(_glyphs_pedestrians_actor_3D);
 
     _glyphs_pedestrians_actor_3D->SetVisibility(false);
 }
 
+void Visualisation::setInstancedAgents(bool instanced)
+{
+    // the worker must not write the models while the arrays are exchanged
+    _preparer->Invalidate();
+    _frame2D.SetInstanced(instanced);
+    _frame3D.SetInstanced(instanced);
+    updateAgentMappers();
+    // the models write the current frame again with the next update
+    _dirty |= DIRTY_SETTINGS;
+}
+
+void Visualisation::updateAgentMappers()
+{
+    if(!_glyphs_pedestrians_actor_2D || !_glyphs_pedestrians_actor_3D) {
+        // applied by start()
+        return;
+    }
+    const auto tier = _lod.Tier();
+    if(tier == LodTier::SPRITES || tier == LodTier::DENSITY) {
+        // overlapping splats add up, dense regions become brighter
+        const bool density = tier == LodTier::DENSITY;
+        for(auto * mapper : {_sprites_mapper_2D.Get(), _sprites_mapper_3D.Get()}) {
+            mapper->SetEmissive(density);
+            mapper->SetSplatShaderCode(density ? nullptr : discSplatShader);
+            mapper->SetScaleFactor(density ? _densityScale : typicalAgentRadius);
+        }
+        _glyphs_pedestrians_actor_2D->SetMapper(_sprites_mapper_2D);
+        _glyphs_pedestrians_actor_3D->SetMapper(_sprites_mapper_3D);
+        return;
+    }
+
+    // the glyph pipelines pick up the resolution with the next render
+    const int resolution = tier == LodTier::FULL ? fullResolution : lowPolyResolution;
+    _agentShape2D->SetCircumferentialResolution(resolution);
+    _agentShape3D->SetResolution(resolution);
+    if(_settings->instancedAgents) {
+        _glyphs_pedestrians_actor_2D->SetMapper(_instanced_pedestrians_mapper_2D);
+        _glyphs_directions_actor->SetMapper(_instanced_directions_mapper);
+        _glyphs_pedestrians_actor_3D->SetMapper(_instanced_pedestrians_mapper_3D);
+    } else {
+        _glyphs_pedestrians_actor_2D->SetMapper(_glyphs_pedestrians_mapper_2D);
+        _glyphs_directions_actor->SetMapper(_glyphs_directions_mapper);
+        _glyphs_pedestrians_actor_3D->SetMapper(_glyphs_pedestrians_mapper_3D);
+    }
+}
+
+void Visualisation::updateLevelOfDetail()
+{
+    const double pixels = pixelsPerWorldUnit(_renderer);
+    if(pixels <= 0) {
+        // the window is not shown yet
+        return;
+    }
+    const auto * agents =
+        _settings->mode == RenderMode::MODE_2D ? _frame2D.GetPolyData() : _frame3D.GetPolyData();
+    const int agentCount = static_cast<int>(agents->GetNumberOfPoints());
+    // without automatic level of detail the agents are always drawn in full detail
+    const bool changed = _settings->levelOfDetail ?
+                             _lod.Update(2 * typicalAgentRadius * pixels, agentCount) :
+                             _lod.Update(std::numeric_limits<double>::max(), 0);
+
+    // the density splats keep their size on screen while zooming
+    const double densityScale = densitySplatPixels / pixels;
+    const bool rescaled = std::abs(densityScale - _densityScale) > 0.1 * _densityScale;
+    if(rescaled) {
+        _densityScale = densityScale;
+    }
+    if(changed || (rescaled && _lod.Tier() == LodTier::DENSITY)) {
+        updateAgentMappers();
+        _dirty |= DIRTY_SETTINGS;
+    }
+}
+
 void Visualisation::init() {}
 
 void Visualisation::finalize() {}
@@ -463,6 +673,7 @@ void Visualisation::initLegend(/*std::vector scalars*/)
 void Visualisation::setAxisVisible(bool status)
 {
     _axis->SetVisibility(status);
+    _dirty |= DIRTY_SETTINGS;
 }
 
 void Visualisation::setCameraPerspective(int mode, int degree)
@@ -490,6 +701,7 @@ void Visualisation::setCameraPerspective(int mode, int degree)
         break;
     }
     _renderer->ResetCamera();
+    _dirty |= DIRTY_CAMERA;
 }
 
 void Visualisation::setBackgroundColor(const QColor & col)
@@ -498,6 +710,8 @@ void Visualisation::setBackgroundColor(const QColor & col)
     QcolorToDouble(col, bgcolor);
     if(_renderer != NULL)
         _renderer->SetBackground(bgcolor);
+    // the colors of the trains are derived from the background
+    _dirty |= DIRTY_SETTINGS | DIRTY_TRAINS;
 }
 
 void Visualisation::setWindowTitle(QString title)
@@ -524,6 +738,7 @@ void Visualisation::setWallsColor(const QColor & color)
     double rbgColor[3];
     QcolorToDouble(color, rbgColor);
     _geometry.ChangeWallsColor(rbgColor);
+    _dirty |= DIRTY_SETTINGS;
 }
 
 void Visualisation::setFloorColor(const QColor & color)
@@ -531,6 +746,7 @@ void Visualisation::setFloorColor(const QColor & color)
     double rbgColor[3];
     QcolorToDouble(color, rbgColor);
     _geometry.ChangeFloorColor(rbgColor);
+    _dirty |= DIRTY_SETTINGS;
 }
 
 void Visualisation::setObstacleColor(const QColor & color)
@@ -538,11 +754,13 @@ void Visualisation::setObstacleColor(const QColor & color)
     double rbgColor[3];
     QcolorToDouble(color, rbgColor);
     _geometry.ChangeObstaclesColor(rbgColor);
+    _dirty |= DIRTY_SETTINGS;
 }
 
 void Visualisation::setGeometryLabelsVisibility(int v)
 {
     _geometry.ShowGeometryLabels(v);
+    _dirty |= DIRTY_SETTINGS;
 }
 
 void Visualisation::setExitsColor(const QColor & color)
@@ -551,6 +769,7 @@ void Visualisation::setExitsColor(const QColor & color)
     QcolorToDouble(color, rbgColor);
     // HH
     _geometry.ChangeExitsColor(rbgColor);
+    _dirty |= DIRTY_SETTINGS;
 }
 
 void Visualisation::setNavLinesColor(const QColor & color)
@@ -558,6 +777,7 @@ void Visualisation::setNavLinesColor(const QColor & color)
     double rbgColor[3];
     QcolorToDouble(color, rbgColor);
     _geometry.ChangeNavLinesColor(rbgColor);
+    _dirty |= DIRTY_SETTINGS;
 }
 
 /// enable/disable 2D
@@ -565,6 +785,7 @@ void Visualisation::setNavLinesColor(const QColor & color)
 void Visualisation::setGeometryVisibility2D(bool status)
 {
     _geometry.Set2D(status);
+    _dirty |= DIRTY_SETTINGS;
 }
 
 /// enable/disable 3D
@@ -572,11 +793,13 @@ void Visualisation::setGeometryVisibility2D(bool status)
 void Visualisation::setGeometryVisibility3D(bool status)
 {
     _geometry.Set3D(status);
+    _dirty |= DIRTY_SETTINGS;
 }
 
 void Visualisation::setOnscreenInformationVisibility(bool show)
 {
     _runningTime->SetVisibility(show);
+    _dirty |= DIRTY_SETTINGS;
 }
 
 vtkSmartPointer<vtkPolyData>
@@ -632,57 +855,23 @@ getTrainData(Point trainStart, Point trainEnd, std::vector<Point> doorPoints, do
     return linesPolyData;
 }
 
-void Visualisation::onExecute()
+void Visualisation::initTrains()
 {
-    vtkRenderWindowInteractor * const iren = _renderWindow->GetInteractor();
-
-    int frameNumber         = 0;
-    int nPeds               = 0;
-    static bool isRecording = false;
-
-
-    if(_trajectories->getFrameCount() > 0) {
-        if(!is_pause) {
-            _trajectories->moveFrameBy(_replay_speed);
-        }
-        const auto * frame = _trajectories->currentFrame();
-
-        nPeds = frame->Size();
-        update();
-        auto FrameElements = frame->GetFrameElements();
-
-        if(_settings->showTrajectories) {
-            const auto & elements = frame->GetFrameElements();
-            for(auto && e : elements) {
-                _trail_plotter->PlotPoint(e.pos, e.color);
-            }
-        }
-    }
-
-    frameNumber = _trajectories->currentIndex();
-    emit signalFrameNumber(frameNumber);
-
-    double now      = frameNumber * iren->GetTimerDuration(_timer_id) / 1000;
-    int countTrains = 0;
     char label[100];
-
-    for(auto tab : _trainTimeTables) {
-        VTK_CREATE(vtkTextActor3D, textActor);
-        auto trainType = tab.second->type;
-        sprintf(label, "%s_%d", trainType.c_str(), tab.second->id);
-        auto trainId      = tab.second->id;
-        auto trackStart   = tab.second->pstart;
-        auto trackEnd     = tab.second->pend;
-        auto trainOffset  = tab.second->train_offset;
-        auto reversed     = tab.second->reversed;
-        auto train        = _trainTypes[trainType];
-        auto train_length = train->_length;
-        auto doors        = train->_doors;
-        std::vector<Point> doorPoints;
-        auto mapper         = tab.second->mapper;
-        auto actor          = tab.second->actor;
-        double elevation    = tab.second->elevation;
-        auto txtActor       = tab.second->textActor;
+    for(const auto & [id, tab] : _trainTimeTables) {
+        const auto & trainType = tab->type;
+        sprintf(label, "%s_%d", trainType.c_str(), tab->id);
+        auto trackStart     = tab->pstart;
+        auto trackEnd       = tab->pend;
+        auto trainOffset    = tab->train_offset;
+        auto reversed       = tab->reversed;
+        auto train          = _trainTypes[trainType];
+        auto train_length   = train->_length;
+        auto doors          = train->_doors;
+        auto mapper         = tab->mapper;
+        auto actor          = tab->actor;
+        double elevation    = tab->elevation;
+        auto txtActor       = tab->textActor;
         auto trackDirection = (reversed) ? (trackStart - trackEnd) : (trackEnd - trackStart);
         trackDirection      = trackDirection.Normalized();
         auto trainStart     = (reversed) ? trackEnd + trackDirection * trainOffset :
@@ -690,86 +879,154 @@ void Visualisation::onExecute()
         auto trainEnd = (reversed) ? trackEnd + trackDirection * (trainOffset + train_length) :
                                      trackStart + trackDirection * (trainOffset + train_length);
 
+        std::vector<Point> doorPoints;
         for(auto door : doors) {
             Point trainDirection = trainEnd - trainStart;
-            ;
-            trainDirection = trainDirection.Normalized();
-            Point point1   = trainStart + trainDirection * (door._distance);
-            Point point2   = trainStart + trainDirection * (door._distance + door._width);
+            trainDirection       = trainDirection.Normalized();
+            Point point1         = trainStart + trainDirection * (door._distance);
+            Point point2         = trainStart + trainDirection * (door._distance + door._width);
             doorPoints.push_back(point1);
             doorPoints.push_back(point2);
         } // doors
-        // FIXME(kkratz): This is broken!
-        static int once = 1;
-        if(once) {
-            auto data = getTrainData(trainStart, trainEnd, doorPoints, elevation);
-            mapper->SetInputData(data);
-            actor->SetMapper(mapper);
-            actor->GetProperty()->SetLineWidth(10);
-            actor->GetProperty()->SetOpacity(0.1); // feels cool!
-            if(trainType == "RE") {
-                actor->GetProperty()->SetColor(
-                    std::abs(0.0 - _renderer->GetBackground()[0]),
-                    std::abs(1.0 - _renderer->GetBackground()[1]),
-                    std::abs(1.0 - _renderer->GetBackground()[2]));
-            } else {
-                actor->GetProperty()->SetColor(
-                    std::abs(0.9 - _renderer->GetBackground()[0]),
-                    std::abs(0.9 - _renderer->GetBackground()[1]),
-                    std::abs(1.0 - _renderer->GetBackground()[2]));
-            }
-            // text
-            txtActor->GetTextProperty()->SetOpacity(0.7);
-            double pos_x = 50 * (trainStart._x + trainEnd._x + 0.5);
-            double pos_y = 50 * (trainStart._y + trainEnd._y + 0.5);
-
-            txtActor->SetPosition(pos_x, pos_y + 2, 20);
-            txtActor->SetInput(label);
-            txtActor->GetTextProperty()->SetFontSize(30);
-            txtActor->GetTextProperty()->SetBold(true);
-            if(trainType == "RE") {
-                txtActor->GetTextProperty()->SetColor(
-                    std::abs(0.0 - _renderer->GetBackground()[0]),
-                    std::abs(1.0 - _renderer->GetBackground()[1]),
-                    std::abs(1.0 - _renderer->GetBackground()[2]));
-            } else {
-                txtActor->GetTextProperty()->SetColor(
-                    std::abs(0.9 - _renderer->GetBackground()[0]),
-                    std::abs(0.9 - _renderer->GetBackground()[1]),
-                    std::abs(0.5 - _renderer->GetBackground()[2]));
-            }
-            txtActor->SetVisibility(false);
+
+        auto data = getTrainData(trainStart, trainEnd, doorPoints, elevation);
+        mapper->SetInputData(data);
+        actor->SetMapper(mapper);
+        actor->GetProperty()->SetLineWidth(10);
+        actor->GetProperty()->SetOpacity(0.1); // feels cool!
+        if(trainType == "RE") {
+            actor->GetProperty()->SetColor(
+                std::abs(0.0 - _renderer->GetBackground()[0]),
+                std::abs(1.0 - _renderer->GetBackground()[1]),
+                std::abs(1.0 - _renderer->GetBackground()[2]));
+        } else {
+            actor->GetProperty()->SetColor(
+                std::abs(0.9 - _renderer->GetBackground()[0]),
+                std::abs(0.9 - _renderer->GetBackground()[1]),
+                std::abs(1.0 - _renderer->GetBackground()[2]));
         }
-        if((now >= tab.second->tin) && (now <= tab.second->tout)) {
-            actor->SetVisibility(true);
-            txtActor->SetVisibility(true);
+        // text
+        txtActor->GetTextProperty()->SetOpacity(0.7);
+        double pos_x = 50 * (trainStart._x + trainEnd._x + 0.5);
+        double pos_y = 50 * (trainStart._y + trainEnd._y + 0.5);
+
+        txtActor->SetPosition(pos_x, pos_y + 2, 20);
+        txtActor->SetInput(label);
+        txtActor->GetTextProperty()->SetFontSize(30);
+        txtActor->GetTextProperty()->SetBold(true);
+        if(trainType == "RE") {
+            txtActor->GetTextProperty()->SetColor(
+                std::abs(0.0 - _renderer->GetBackground()[0]),
+                std::abs(1.0 - _renderer->GetBackground()[1]),
+                std::abs(1.0 - _renderer->GetBackground()[2]));
         } else {
-            actor->SetVisibility(false);
-            txtActor->SetVisibility(false);
+            txtActor->GetTextProperty()->SetColor(
+                std::abs(0.9 - _renderer->GetBackground()[0]),
+                std::abs(0.9 - _renderer->GetBackground()[1]),
+                std::abs(0.5 - _renderer->GetBackground()[2]));
         }
-        if(once) {
-            _renderer->AddActor(actor);
-            _renderer->AddActor(txtActor);
-            if(countTrains == _trainTimeTables.size())
-                once = 0;
+        // adding an actor twice has no effect
+        _renderer->AddActor(actor);
+        _renderer->AddActor(txtActor);
+    } // time table
+}
+
+void Visualisation::updateTrains()
+{
+    const double now = _trajectories->currentIndex() / _trajectories->getFps();
+    for(const auto & [id, tab] : _trainTimeTables) {
+        const bool atStation = (now >= tab->tin) && (now <= tab->tout);
+        tab->actor->SetVisibility(atStation);
+        tab->textActor->SetVisibility(atStation);
+    }
+}
+
+void Visualisation::onExecute()
+{
+    // frames are appended while a file is loaded in the background
+    const int frameCount = _trajectories->getFrameCount();
+    if(frameCount != _lastFrameCount) {
+        _lastFrameCount = frameCount;
+        emit signalMaxFramesUpdated(frameCount);
+        _dirty |= DIRTY_FRAME;
+    }
+
+    // the frame is also moved by the player controls and the slider
+    float fraction{0};
+    if(frameCount > 0 && _clock.IsRunning()) {
+        const bool seeked = _trajectories->currentIndex() != _lastFrameIndex;
+        if(seeked) {
+            _clock.Seek(_trajectories->currentIndex());
         }
+        if(_clock.Tick(PlaybackClock::Clock::now(), frameCount - 1)) {
+            const double position = _clock.Position();
+            int index             = static_cast<int>(std::floor(position));
+            // Skipping frames anyway when fast-forwarding, only the frames of the coarsest
+            // adequate level of the temporal pyramid are shown, so the replay visits the same
+            // frames on every pass and no interpolation is needed.
+            const int level = TemporalPyramid::levelForStride(std::abs(_clock.ExpectedAdvance()));
+            index           = TemporalPyramid::snapToLevel(index, level);
+            // moving relative to the cursor tells an out-of-core trajectory the replay direction
+            _trajectories->moveFrameBy(index - _trajectories->currentIndex());
+            if(_settings->interpolateFrames && level == 0 && index + 1 < frameCount) {
+                fraction = static_cast<float>(position - index);
+            }
+        } else if(!seeked) {
+            fraction = _lastFraction;
+        }
+    }
+    const int frameNumber = _trajectories->currentIndex();
+    if(frameNumber != _lastFrameIndex || fraction != _lastFraction) {
+        _lastFrameIndex = frameNumber;
+        _lastFraction   = fraction;
+        _dirty |= DIRTY_FRAME;
+    }
 
-        countTrains++;
-    } // time table
+    updateLevelOfDetail();
 
+    int * winSize = _renderWindow->GetSize();
+    if(_lastWindowSize[0] != winSize[0] || _lastWindowSize[1] != winSize[1]) {
+        _dirty |= DIRTY_CAMERA;
+    }
 
-    int * winSize       = _renderWindow->GetSize();
-    static int lastWinX = winSize[0] + 1; // +1 to trigger a first change
-    static int lastWinY = winSize[1];
-    sprintf(
-        runningTimeText,
-        "Pedestrians: %d      Time: %ld Sec",
-        nPeds,
-        frameNumber * iren->GetTimerDuration(_timer_id) / 1000);
-    runningTime->SetInput(runningTimeText);
-    runningTime->Modified();
+    if(_dirty == DIRTY_NONE) {
+        // nothing changed since the last render, e.g. the replay is paused
+        return;
+    }
 
-    if((lastWinX != winSize[0]) || (lastWinY != winSize[1]) /*|| (frameNumber<10)*/) {
+    if(frameCount > 0 && (_dirty & (DIRTY_FRAME | DIRTY_SETTINGS))) {
+        update(frameNumber + fraction);
+
+        if(_settings->showTrajectories) {
+            // a trail never needs to be longer than the trajectory
+            const double trailFrames = std::min<double>(
+                std::round(_settings->trailDuration * _trajectories->getFps()), frameCount);
+            _trail_plotter->SetWindow(static_cast<size_t>(std::max(1.0, trailFrames)));
+            _trail_plotter->Update(*_trajectories, frameNumber);
+        }
+    }
+
+    if(_dirty & DIRTY_TRAINS) {
+        initTrains();
+    }
+    if(_dirty & (DIRTY_FRAME | DIRTY_TRAINS)) {
+        updateTrains();
+    }
+
+    if(_dirty & DIRTY_FRAME) {
+        emit signalFrameNumber(frameNumber);
+
+        const int nPeds = frameCount > 0 ? _trajectories->currentFrame().Size() : 0;
+        sprintf(
+            runningTimeText,
+            "Pedestrians: %d      Time: %ld Sec",
+            nPeds,
+            static_cast<long>(frameNumber / _trajectories->getFps()));
+        runningTime->SetInput(runningTimeText);
+        runningTime->Modified();
+    }
+
+    if(_dirty & DIRTY_CAMERA) {
         static std::string winBaseName(_renderWindow->GetWindowName());
         std::string winName = winBaseName;
         std::string s;
@@ -786,15 +1043,21 @@ void Visualisation::onExecute()
         runningTime->SetPosition(posX, posY);
         _renderWindow->SetWindowName(winName.c_str());
 
-        lastWinX = winSize[0];
-        lastWinY = winSize[1];
+        _lastWindowSize[0] = winSize[0];
+        _lastWindowSize[1] = winSize[1];
     }
 
+    const bool frameChanged = _dirty & DIRTY_FRAME;
+    const auto renderStart  = PlaybackClock::Clock::now();
     renderFrame();
+    _clock.RenderFinished(PlaybackClock::Clock::now() - renderStart);
 
-    if(_settings->recordPNGsequence) {
+    if(_settings->recordPNGsequence && frameChanged) {
         takeScreenshotSequence();
     }
+    if(_recorder.IsOpen() && frameChanged) {
+        _recorder.Write(_renderWindow);
+    }
 }
 
 void Visualisation::onMouseMove(double x, double y, double z)
@@ -804,38 +1067,50 @@ void Visualisation::onMouseMove(double x, double y, double z)
 
 void Visualisation::takeScreenshot()
 {
-    static int imageID                     = 0;
-    vtkWindowToImageFilter * winToImFilter = vtkWindowToImageFilter::New();
-    winToImFilter->SetInput(_renderWindow);
-    vtkPNGWriter * image = vtkPNGWriter::New();
-    image->SetInputConnection(winToImFilter->GetOutputPort());
-    winToImFilter->Delete();
-
-    QString screenshots = QDir::homePath() + QDir::separator() + "Desktop" + QDir::separator() +
-                          "JPSvis_Files" + QDir::separator();
-    // create directory if not exits
-    if(!QDir(screenshots).exists()) {
-        QDir dir;
-        if(!dir.mkpath(screenshots)) {
-            // try with the current directory
-            screenshots = "";
-        }
-    }
-
+    static int imageID = 0;
+    const std::string date =
+        QString(QDateTime::currentDateTime().toString("yyMMdd_hh")).toStdString();
 
     char filename[256] = {0};
-    std::string date   = QString(QDateTime::currentDateTime().toString("yyMMdd_hh")).toStdString();
-
     sprintf(filename, "travisto_snap_%sh_%d.png", date.c_str(), imageID++);
 
     // append the prefix
-    screenshots += _settings->filesPrefix;
-    screenshots += QString(filename);
-    image->SetFileName(screenshots.toStdString().c_str());
-    winToImFilter->Modified();
+    const QString screenshot = outputDirectory().filePath(_settings->filesPrefix + filename);
+    _imageWriter.Capture(_renderWindow, screenshot.toStdString());
+}
 
-    image->Write();
-    image->Delete();
+void Visualisation::finishScreenshotSequence()
+{
+    if(_sequenceDirectory.isEmpty()) {
+        return;
+    }
+    _imageWriter.Flush();
+    Log::Info(
+        "wrote %d images to <%s>", _sequenceLength, _sequenceDirectory.toStdString().c_str());
+    _sequenceDirectory.clear();
+    _sequenceLength = 0;
+}
+
+bool Visualisation::startRecording(const std::filesystem::path & output)
+{
+    const int * size = _renderWindow->GetSize();
+    // a trajectory without a frame rate is recorded at the rate it is replayed
+    const double fps =
+        _trajectories->getFps() > 0 ? _trajectories->getFps() : PlaybackClock::MAX_DISPLAY_RATE;
+    if(!_recorder.Open(output, size[0], size[1], fps)) {
+        return false;
+    }
+    // one recorded frame per written video frame, independent of the display rate
+    _clock.SetFixedStep(true);
+    // start with the frame currently shown
+    _dirty |= DIRTY_FRAME;
+    return true;
+}
+
+bool Visualisation::stopRecording()
+{
+    _clock.SetFixedStep(false);
+    return _recorder.Close();
 }
 
 int Visualisation::computeFontSize()
@@ -850,42 +1125,34 @@ int Visualisation::computeFontSize()
 /// take png screenshot sequence
 void Visualisation::takeScreenshotSequence()
 {
-    static int imageID                     = 0;
-    vtkWindowToImageFilter * winToImFilter = vtkWindowToImageFilter::New();
-    winToImFilter->SetInput(_renderWindow);
-    vtkPNGWriter * image = vtkPNGWriter::New();
-    image->SetInputConnection(winToImFilter->GetOutputPort());
-    winToImFilter->Delete();
-
-    QString screenshots = QDir::homePath() + QDir::separator() + "Desktop" + QDir::separator() +
-                          "JPSvis_Files" + QDir::separator();
-
-    screenshots.append(
-        "./png_seq_" + QDateTime::currentDateTime().toString("yyMMddhh") + "_" +
-        _settings->filesPrefix);
-    screenshots.truncate(screenshots.size() - 1);
-
-    // create directory if not exits
-    if(!QDir(screenshots).exists()) {
-        QDir dir;
-        if(!dir.mkpath(screenshots)) {
-            cerr << "could not create directory: " << screenshots.toStdString();
-            // try with the current directory
-            screenshots = "./png_seq_" + QDateTime::currentDateTime().toString("yyMMdd") + "_" +
-                          _settings->filesPrefix;
-            screenshots.truncate(screenshots.size() - 1);
+    if(_sequenceDirectory.isEmpty()) {
+        // every recording goes to a directory of its own
+        const QString name = _settings->filesPrefix + "png_seq_" +
+                             QDateTime::currentDateTime().toString("yyMMdd_hhmmss");
+        QDir directory = outputDirectory();
+        if(!directory.mkpath(name)) {
+            Log::Error("could not create directory <%s>", qUtf8Printable(directory.filePath(name)));
+            return;
         }
+        _sequenceDirectory = directory.filePath(name);
+        _sequenceLength    = 0;
     }
 
-
     char filename[30] = {0};
-    sprintf(filename, "/tmp_%07d.png", imageID++);
-    screenshots.append(filename);
-    image->SetFileName(screenshots.toStdString().c_str());
-    winToImFilter->Modified();
+    sprintf(filename, "frame_%07d.png", _sequenceLength++);
+    _imageWriter.Capture(_renderWindow, QDir(_sequenceDirectory).filePath(filename).toStdString());
+}
 
-    image->Write();
-    image->Delete();
+QDir Visualisation::outputDirectory() const
+{
+    QDir directory(_settings->outputDirectory);
+    if(!directory.mkpath(".")) {
+        Log::Warning(
+            "could not create directory <%s>, using the current directory",
+            _settings->outputDirectory.toStdString().c_str());
+        return QDir::current();
+    }
+    return directory;
 }
 
 double Visualisation::trajectoryRecordingFps() const
@@ -893,12 +1160,18 @@ double Visualisation::trajectoryRecordingFps() const
     return _trajectories->getFps();
 }
 
-void Visualisation::ChangeReplaySpeed(int frames)
+void Visualisation::ChangeReplaySpeed(int speed)
 {
-    _replay_speed = frames;
+    _replay_speed = speed;
+    _clock.SetSpeed(speed);
 }
 
 void Visualisation::pauseRendering(bool paused)
 {
     is_pause = paused;
+    if(paused) {
+        _clock.Stop();
+    } else {
+        _clock.Start(_trajectories->currentIndex(), PlaybackClock::Clock::now());
+    }
 }
@@ -32,11 +32,18 @@
  */
 #pragma once
 
+#include "FrameModel.h"
+#include "FramePreparer.h"
+#include "ImageWriterPool.h"
 #include "InteractorStyle.h"
+#include "LevelOfDetail.h"
+#include "PlaybackClock.h"
 #include "Settings.h"
+#include "TrailPlotter.h"
 #include "TrajectoryData.h"
+#include "VideoWriter.h"
 #include "geometry/GeometryFactory.h"
-#include "geometry/PointPlotter.h"
+#include "geometry/LabelPlotter.h"
 #include "trains/train.h"
 
 #include <QDateTime>
@@ -44,7 +51,8 @@
 #include <QObject>
 #include <QThread>
 #include <vtkGlyph3D.h>
-#include <vtkPNGWriter.h>
+#include <vtkGlyph3DMapper.h>
+#include <vtkPointGaussianMapper.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkSmartPointer.h>
 #include <vtkTensorGlyph.h>
@@ -61,14 +69,14 @@ class vtkRenderWindowInteractor;
 class vtkActor;
 class vtkAxesActor;
 class vtkCamera;
+class vtkCylinderSource;
+class vtkDiskSource;
 class vtkTextActor;
 class vtkObject;
 
 class Pedestrian;
 class TrajectoryData;
 class FacilityGeometry;
-class TrailPlotter;
-class PointPlotter;
 
 
 class Visualisation : public QObject
@@ -76,6 +84,21 @@ class Visualisation : public QObject
     Q_OBJECT
 
 public:
+    /// Parts of the scene that are out of date. The timer callback only does the work for the
+    /// parts that are marked and does not render at all if nothing is marked.
+    enum Dirty : unsigned {
+        DIRTY_NONE = 0,
+        /// the displayed frame changed, e.g. by replaying or seeking
+        DIRTY_FRAME = 1u << 0,
+        /// settings affecting the visibility of actors changed
+        DIRTY_SETTINGS = 1u << 1,
+        /// the camera or the window changed
+        DIRTY_CAMERA = 1u << 2,
+        /// the trains or their time tables changed
+        DIRTY_TRAINS = 1u << 3,
+        DIRTY_ALL    = DIRTY_FRAME | DIRTY_SETTINGS | DIRTY_CAMERA | DIRTY_TRAINS
+    };
+
     Visualisation(
         QObject * parent,
         vtkRenderWindow * renderWindow,
@@ -86,7 +109,15 @@ public:
     void stop();
     void pauseRendering(bool paused);
 
-    void update();
+    /// Marks parts of the scene as out of date, they are updated and rendered with the next timer
+    /// tick. Changes made through the setters of this class are tracked already, this is needed
+    /// after changing '_settings' directly.
+    /// @param parts combination of Dirty flags
+    void invalidate(unsigned parts);
+
+    /// Presents the agents at the replay position 'position' and prepares the ones expected next
+    /// @param position replay position in frames, between two frames if interpolated
+    void update(double position);
     void renderFrame();
 
     void setAxisVisible(bool status);
@@ -126,6 +157,12 @@ public:
     /// change the background color of the rendering windows
     void setBackgroundColor(const QColor & col);
 
+    /// Selects how agents are drawn. Instanced rendering draws the glyph geometry on the GPU and
+    /// only uploads per agent attributes, otherwise vtkTensorGlyph copies the geometry for every
+    /// agent on the CPU.
+    /// @param instanced use instanced rendering if true
+    void setInstancedAgents(bool instanced);
+
     /// change the walls color
     void setWallsColor(const QColor & color);
 
@@ -172,19 +209,34 @@ public:
     /// make a png screenshot of the renderwindows
     void takeScreenshot();
 
+    /// Waits until the images of the recorded PNG sequence are written, the next recording
+    /// starts a new sequence
+    void finishScreenshotSequence();
+
+    /// Records every frame presented from now on, see VideoWriter
+    /// @param output video file, or first image of a PNG sequence if it ends in ".png"
+    /// @return false if the recording could not be started
+    bool startRecording(const std::filesystem::path & output);
+
+    /// Finishes the recording started with startRecording()
+    /// @return false if the video could not be encoded
+    bool stopRecording();
+
     /// Returns the fps the trajectory data was recorded.
     /// If no trajectory data was loaded, i.e. only geometry is rendered the will return 0
     /// @return fps of the trajectory data.
     double trajectoryRecordingFps() const;
 
-    /// Changes the replay speed, i.e. the numer of frames advaned per render call.
+    /// Changes the replay speed, i.e. the replayed seconds per second. The number of frames
+    /// advanced per rendered frame depends on the recording fps and the display rate.
     /// A negative number will make the animation play backwards.
-    /// @param frames to move per iteration.
-    void ChangeReplaySpeed(int frames);
+    /// @param speed replayed seconds per second, also the number of frames to move with the player
+    /// controls.
+    void ChangeReplaySpeed(int speed);
 
-    /// Returns the current replay speed in flames. The number may be negative to indicate the
-    /// replay running backwards.
-    /// @return reply_speed in frames per iteration
+    /// Returns the current replay speed. The number may be negative to indicate the replay
+    /// running backwards.
+    /// @return reply_speed in replayed seconds per second
     int replaySpeed() const { return _replay_speed; }
 
 signals:
@@ -193,6 +245,18 @@ signals:
     void signalMousePositionUpdated(double x, double y, double z);
 
 private:
+    /// Connects the agent actors to the mappers of the current level of detail and instancing
+    void updateAgentMappers();
+
+    /// Selects the level of detail for the current camera and number of agents
+    void updateLevelOfDetail();
+
+    /// Sets up the actors of the trains, needed whenever the trains or the background change
+    void initTrains();
+
+    /// Shows the trains that are at the station at the time of the current frame
+    void updateTrains();
+
     /// initialize the legend
     void initLegend(/*std::vector scalars*/);
 
@@ -213,6 +277,10 @@ private:
     /// take png screenshots sequence
     void takeScreenshotSequence();
 
+    /// @return the output directory of the settings, created if needed, or the current
+    /// directory if it cannot be created
+    QDir outputDirectory() const;
+
     /// Compute fontsize based on DPI
     /// @return fontsize
     int computeFontSize();
@@ -229,19 +297,56 @@ private:
     vtkSmartPointer<vtkAxesActor> _axis;
     vtkSmartPointer<vtkTextActor> _runningTime;
     vtkSmartPointer<vtkCamera> _topViewCamera;
+    /// Agents of the current frame, input of the 2D glyphs and labels
+    Frame2DModel _frame2D{};
+    /// Agents of the current frame, input of the 3D glyphs
+    Frame3DModel _frame3D{};
+    /// Writes the models on a worker thread, destroyed before them
+    std::unique_ptr<FramePreparer> _preparer;
     vtkSmartPointer<vtkTensorGlyph> _glyphs_pedestrians;
+    vtkSmartPointer<vtkDiskSource> _agentShape2D;
+    vtkSmartPointer<vtkCylinderSource> _agentShape3D;
+    vtkSmartPointer<vtkPointGaussianMapper> _sprites_mapper_2D;
+    vtkSmartPointer<vtkPointGaussianMapper> _sprites_mapper_3D;
+    LevelOfDetail _lod{};
+    /// Size of the density splats in world units
+    double _densityScale{0};
+    vtkSmartPointer<vtkPolyDataMapper> _glyphs_pedestrians_mapper_2D;
+    vtkSmartPointer<vtkGlyph3DMapper> _instanced_pedestrians_mapper_2D;
+    vtkSmartPointer<vtkPolyDataMapper> _glyphs_directions_mapper;
+    vtkSmartPointer<vtkGlyph3DMapper> _instanced_directions_mapper;
     vtkSmartPointer<vtkActor> _glyphs_directions_actor;
     vtkSmartPointer<vtkActor> _glyphs_pedestrians_actor_2D;
-    vtkSmartPointer<vtkActor2D> _pedestrians_labels;
+    std::unique_ptr<LabelPlotter> _pedestrians_labels;
     vtkSmartPointer<vtkTensorGlyph> _glyphs_directions;
     vtkSmartPointer<vtkTensorGlyph> _glyphs_pedestrians_3D;
+    vtkSmartPointer<vtkPolyDataMapper> _glyphs_pedestrians_mapper_3D;
+    vtkSmartPointer<vtkGlyph3DMapper> _instanced_pedestrians_mapper_3D;
     vtkSmartPointer<vtkActor> _glyphs_pedestrians_actor_3D;
     vtkSmartPointer<vtkTextActor> runningTime{};
     char runningTimeText[50] = {};
     QString _winTitle;
     vtkSmartPointer<vtkCallbackCommand> _timer_cb;
     int _timer_id = 1;
-    std::unique_ptr<PointPlotter> _trail_plotter{nullptr};
+    /// Number of frames last reported with signalMaxFramesUpdated
+    int _lastFrameCount{0};
+    /// Index of the frame last rendered, -1 if none
+    int _lastFrameIndex{-1};
+    /// Replay position between the current and the next frame last rendered, in [0, 1)
+    float _lastFraction{0};
+    PlaybackClock _clock{};
+    /// Window size the on screen information was last placed for
+    int _lastWindowSize[2]{0, 0};
+    /// Combination of Dirty flags
+    unsigned _dirty{DIRTY_ALL};
+    std::unique_ptr<TrailPlotter> _trail_plotter{nullptr};
+    VideoWriter _recorder{};
+    /// Compresses and writes the screenshots in the background
+    ImageWriterPool _imageWriter{};
+    /// Directory of the PNG sequence being recorded, empty if none
+    QString _sequenceDirectory{};
+    /// Number of images in the PNG sequence being recorded
+    int _sequenceLength{0};
     bool is_pause{true};
     int _replay_speed{1};
 };
@@ -0,0 +1,93 @@
+#include "BoxPlotter.h"
+
+#include <cmath>
+#include <vtkActor.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkMath.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+#include <vtkUnsignedCharArray.h>
+
+BoxPlotter::BoxPlotter() :
+    _points(vtkSmartPointer<vtkPoints>::New()),
+    _quads(vtkSmartPointer<vtkCellArray>::New()),
+    _colors(vtkSmartPointer<vtkUnsignedCharArray>::New()),
+    _polyData(vtkSmartPointer<vtkPolyData>::New()),
+    _mapper(vtkSmartPointer<vtkPolyDataMapper>::New()),
+    _actor(vtkSmartPointer<vtkActor>::New())
+{
+    _colors->SetName("colors");
+    _colors->SetNumberOfComponents(3);
+
+    _polyData->SetPoints(_points);
+    _polyData->SetPolys(_quads);
+    _polyData->GetCellData()->SetScalars(_colors);
+
+    _mapper->SetInputData(_polyData);
+    _mapper->SetScalarModeToUseCellData();
+    _mapper->SetColorModeToDirectScalars();
+
+    _actor->SetMapper(_mapper);
+    _actor->GetProperty()->SetLighting(true);
+    _actor->GetProperty()->SetAmbient(0.2);
+    _actor->GetProperty()->SetDiffuse(0.8);
+}
+
+void BoxPlotter::PlotBox(
+    const double base[3],
+    double length,
+    double thickness,
+    double height,
+    double orientation,
+    const double color[3])
+{
+    // corners of the box centered at the origin with its axis along y, rotated around z
+    const double angle    = vtkMath::RadiansFromDegrees(orientation);
+    const double c        = std::cos(angle);
+    const double s        = std::sin(angle);
+    const vtkIdType first = _points->GetNumberOfPoints();
+    for(int k = 0; k < 8; ++k) {
+        const double x = (k & 1 ? 0.5 : -0.5) * thickness;
+        const double y = (k & 2 ? 0.5 : -0.5) * length;
+        const double z = k & 4 ? height : 0;
+        _points->InsertNextPoint(base[0] + c * x - s * y, base[1] + s * x + c * y, base[2] + z);
+    }
+
+    // faces wound counter-clockwise seen from outside
+    static constexpr vtkIdType faces[6][4] = {
+        {0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+    const unsigned char rgb[3] = {
+        static_cast<unsigned char>(std::lround(255 * color[0])),
+        static_cast<unsigned char>(std::lround(255 * color[1])),
+        static_cast<unsigned char>(std::lround(255 * color[2]))};
+    for(const auto & face : faces) {
+        const vtkIdType ids[4] = {
+            first + face[0], first + face[1], first + face[2], first + face[3]};
+        _quads->InsertNextCell(4, ids);
+        _colors->InsertNextTypedTuple(rgb);
+    }
+
+    _points->Modified();
+    _quads->Modified();
+    _colors->Modified();
+    _polyData->Modified();
+}
+
+void BoxPlotter::SetColor(const double color[3])
+{
+    _mapper->ScalarVisibilityOff();
+    _actor->GetProperty()->SetColor(color[0], color[1], color[2]);
+}
+
+void BoxPlotter::SetVisibility(bool status)
+{
+    _actor->SetVisibility(status);
+}
+
+vtkActor * BoxPlotter::getActor() const
+{
+    return _actor;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vtkSmartPointer.h>
+
+class vtkActor;
+class vtkCellArray;
+class vtkPoints;
+class vtkPolyData;
+class vtkPolyDataMapper;
+class vtkUnsignedCharArray;
+
+/// Plots many boxes, e.g. all walls of a subroom, into a single polydata rendered by one actor.
+/// Each box is made of 8 points and 6 quads, the color of a box is stored per cell. Compared to
+/// one source, mapper and actor per box this reduces the number of draw calls to one.
+class BoxPlotter
+{
+    vtkSmartPointer<vtkPoints> _points;
+    vtkSmartPointer<vtkCellArray> _quads;
+    vtkSmartPointer<vtkUnsignedCharArray> _colors;
+    vtkSmartPointer<vtkPolyData> _polyData;
+    vtkSmartPointer<vtkPolyDataMapper> _mapper;
+    vtkSmartPointer<vtkActor> _actor;
+
+public:
+    BoxPlotter();
+    ~BoxPlotter() = default;
+
+    BoxPlotter(const BoxPlotter &) = delete;
+    BoxPlotter & operator=(const BoxPlotter &) = delete;
+
+    /// Adds a box standing on the ground at 'base'
+    /// @param base center of the bottom face
+    /// @param length extent along the box axis
+    /// @param thickness extent perpendicular to the box axis
+    /// @param height extent in z direction
+    /// @param orientation rotation around z in degrees, the box axis is along y at 0
+    /// @param color RGB in [0, 1]
+    void PlotBox(
+        const double base[3],
+        double length,
+        double thickness,
+        double height,
+        double orientation,
+        const double color[3]);
+
+    /// Overrides the colors of all boxes
+    /// @param color RGB in [0, 1]
+    void SetColor(const double color[3]);
+
+    void SetVisibility(bool status);
+
+    /// @return the actor rendering all boxes
+    vtkActor * getActor() const;
+};
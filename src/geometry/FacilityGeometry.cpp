@@ -31,13 +31,13 @@
 
 #include "FacilityGeometry.h"
 
+#include "BoxPlotter.h"
 #include "JPoint.h"
 #include "LinePlotter2D.h"
 #include "Settings.h"
 #include "general/Macros.h"
 
 #include <vtkActor.h>
-#include <vtkActor2DCollection.h>
 #include <vtkAssembly.h>
 #include <vtkCaptionActor2D.h>
 #include <vtkCaptionRepresentation.h>
@@ -51,13 +51,10 @@
 #include <vtkLookupTable.h>
 #include <vtkPointData.h>
 #include <vtkPolyDataMapper.h>
-#include <vtkProp3DCollection.h>
 #include <vtkProperty.h>
 #include <vtkSmartPointer.h>
 #include <vtkSphereSource.h>
 #include <vtkTextActor.h>
-#include <vtkTextActor3D.h>
-#include <vtkTextProperty.h>
 #include <vtkTriangleFilter.h>
 
 
@@ -70,18 +67,17 @@ FacilityGeometry::FacilityGeometry(
     const string & subroomCaption)
 {
     assembly         = vtkAssembly::New();
-    assembly2D       = vtkAssembly::New();
-    assemblyCaptions = vtkAssembly::New();
+    assembly2D = vtkAssembly::New();
 
-    assemblyWalls3D = vtkAssembly::New();
-    assemblyDoors3D = vtkAssembly::New();
-    assembly3D      = vtkAssembly::New();
+    walls3D    = std::make_unique<BoxPlotter>();
+    doors3D    = std::make_unique<BoxPlotter>();
+    steps3D    = std::make_unique<BoxPlotter>();
+    assembly3D = vtkAssembly::New();
 
     floorActor         = vtkActor::New();
     obstaclesActor     = vtkActor::New();
     gradientFieldActor = vtkActor::New();
 
-    captions       = vtkActor2DCollection::New();
     linesPlotter2D = new LinePlotter2D();
 
     // initializing the lookup table for the colors
@@ -112,14 +108,10 @@ FacilityGeometry::FacilityGeometry(
 FacilityGeometry::~FacilityGeometry()
 {
     lookupTable->Delete();
-    captions->Delete();
 
     assembly->Delete();
     assembly2D->Delete();
-    assemblyCaptions->Delete();
 
-    assemblyWalls3D->Delete();
-    assemblyDoors3D->Delete();
     assembly3D->Delete();
     floorActor->Delete();
     obstaclesActor->Delete();
@@ -132,11 +124,6 @@ vtkAssembly * FacilityGeometry::getActor2D()
     return assembly2D;
 }
 
-vtkAssembly * FacilityGeometry::getCaptionsActor()
-{
-    return assemblyCaptions;
-}
-
 vtkAssembly * FacilityGeometry::getActor3D()
 {
     return assembly3D;
@@ -145,11 +132,11 @@ vtkAssembly * FacilityGeometry::getActor3D()
 void FacilityGeometry::CreateActors()
 {
     assembly2D->AddPart(linesPlotter2D->createAssembly());
-    assembly2D->AddPart(assemblyCaptions);
 
-    assembly3D->AddPart(assemblyDoors3D);
-    assembly3D->AddPart(assemblyWalls3D);
-    assembly3D->AddPart(assemblyCaptions);
+    doors3D->getActor()->GetProperty()->SetOpacity(0.5);
+    assembly3D->AddPart(doors3D->getActor());
+    assembly3D->AddPart(steps3D->getActor());
+    assembly3D->AddPart(walls3D->getActor());
 }
 
 void FacilityGeometry::setVisibility(bool status)
@@ -178,70 +165,29 @@ void FacilityGeometry::addNewElement(
     double orientation,
     ELEMENT_TYPE type)
 {
-    vtkCubeSource * src = vtkCubeSource::New();
-    src->SetCenter(center[0], center[1], center[2]);
-    src->SetYLength(length);
-
-    vtkPolyDataMapper * mapper = vtkPolyDataMapper::New();
-    mapper->SetInputConnection(src->GetOutputPort());
-    src->Delete();
-
-    vtkActor * actor = vtkActor::New();
-    actor->SetMapper(mapper);
-    mapper->Delete();
-    actor->GetProperty()->SetLighting(true);
-    actor->SetOrigin(center[0], center[1], center[2]);
-    actor->RotateZ(orientation);
-    actor->GetProperty()->SetAmbient(0.2);
-    actor->GetProperty()->SetDiffuse(0.8);
-
-    //  double data[3];
-    //  actor->GetPosition(data);
-    //  actor->SetPosition(data[0],data[1],src->GetZLength()/2);
-
+    // the boxes stand on the ground at the elevation of the element
     switch(type) {
         case DOOR: {
             double colorRGB[3];
             lookupTable->GetColor(doorColor, colorRGB);
-            actor->GetProperty()->SetColor(colorRGB);
-            src->SetXLength(doorThickness);
-            src->SetZLength(doorHeight);
-            // src->SetRadius(doorWidth);
-            actor->GetProperty()->SetOpacity(0.5);
-            assemblyDoors3D->AddPart(actor);
+            doors3D->PlotBox(center, length, doorThickness, doorHeight, orientation, colorRGB);
         } break;
         case WALL: {
             double colorRGB[3];
             lookupTable->GetColor(wallColor, colorRGB);
-            actor->GetProperty()->SetColor(colorRGB);
-            // actor->GetProperty()->SetSpecular(1);
-            // actor->GetProperty()->SetDiffuse(1);
-            // actor->GetProperty()->SetAmbient(1);
-
-            src->SetXLength(wallThickness);
-            src->SetZLength(wallHeight);
-            // src->SetRadius(wallWidth);
-            assemblyWalls3D->AddPart(actor);
+            walls3D->PlotBox(center, length, wallThickness, wallHeight, orientation, colorRGB);
         } break;
         case STEP: {
             double colorRGB[3];
             lookupTable->GetColor(stepColor, colorRGB);
-            actor->GetProperty()->SetColor(colorRGB);
-            src->SetXLength(wallThickness); // FIXME, this is wrong
-            src->SetZLength(stepHeight);
-            assemblyDoors3D->AddPart(actor);
+            // FIXME, the thickness is wrong
+            steps3D->PlotBox(center, length, wallThickness, stepHeight, orientation, colorRGB);
         } break;
 
             // default behaviour not defined
         default:
             break;
     }
-
-    // now adjusting the z coordinates
-    double data[3];
-    actor->GetPosition(data);
-    actor->SetPosition(data[0], data[1], src->GetZLength() / 2);
-    actor->Delete();
 }
 
 void FacilityGeometry::addWall(
@@ -803,14 +749,7 @@ void FacilityGeometry::changeWallsColor(double * color)
     assembly2D->Modified();
 
     // 3D parts
-    vtkProp3DCollection * col = assemblyWalls3D->GetParts();
-    assemblyWalls3D->GetActors(col);
-
-    int count = col->GetNumberOfItems();
-    for(int i = 0; i < count; i++) {
-        ((vtkActor *) col->GetItemAsObject(i))->GetProperty()->SetColor(color);
-    }
-    assemblyWalls3D->Modified();
+    walls3D->SetColor(color);
 }
 
 void FacilityGeometry::changeExitsColor(double * color)
@@ -819,15 +758,9 @@ void FacilityGeometry::changeExitsColor(double * color)
     linesPlotter2D->changeDoorsColor(color);
     assembly2D->Modified();
 
-    // 3D part
-    vtkProp3DCollection * col = assemblyDoors3D->GetParts();
-    assemblyDoors3D->GetActors(col);
-
-    int count = col->GetNumberOfItems();
-    for(int i = 0; i < count; i++) {
-        ((vtkActor *) col->GetItemAsObject(i))->GetProperty()->SetColor(color);
-    }
-    assemblyDoors3D->Modified();
+    // 3D part, steps are colored like doors
+    doors3D->SetColor(color);
+    steps3D->SetColor(color);
 }
 
 void FacilityGeometry::changeNavLinesColor(double * color)
@@ -863,14 +796,8 @@ void FacilityGeometry::showDoors(bool status)
     linesPlotter2D->showDoors(status);
     assembly2D->Modified();
 
-    vtkProp3DCollection * col = assemblyDoors3D->GetParts();
-    assemblyDoors3D->GetActors(col);
-
-    int count = col->GetNumberOfItems();
-    for(int i = 0; i < count; i++) {
-        ((vtkActor *) col->GetItemAsObject(i))->SetVisibility(status);
-    }
-    assemblyDoors3D->Modified();
+    doors3D->SetVisibility(status);
+    steps3D->SetVisibility(status);
 }
 
 void FacilityGeometry::showStairs(bool status) {}
@@ -880,14 +807,7 @@ void FacilityGeometry::showWalls(bool status)
     linesPlotter2D->showWalls(status);
     assembly2D->Modified();
 
-    vtkProp3DCollection * col = assemblyWalls3D->GetParts();
-    assemblyWalls3D->GetActors(col);
-
-    int count = col->GetNumberOfItems();
-    for(int i = 0; i < count; i++) {
-        ((vtkActor *) col->GetItemAsObject(i))->SetVisibility(status);
-    }
-    assemblyWalls3D->Modified();
+    walls3D->SetVisibility(status);
 }
 
 void FacilityGeometry::showNavLines(bool status)
@@ -915,10 +835,11 @@ void FacilityGeometry::addObjectLabel(
     std::string caption,
     double color)
 {
-    addNewElementText(center, orientation, caption, color);
+    // names of rooms, obstacles and crossings take precedence over the captions of walls and doors
+    addNewElementText(center, orientation, caption, color, 1);
 }
 
-vtkActor2DCollection * FacilityGeometry::getCaptions()
+const std::vector<FacilityGeometry::Caption> & FacilityGeometry::getCaptions() const
 {
     return captions;
 }
@@ -927,30 +848,27 @@ void FacilityGeometry::addNewElementText(
     double center[3],
     double orientation[3],
     string text,
-    double color)
+    double color,
+    int priority)
 {
-    VTK_CREATE(vtkTextActor3D, caption);
-    caption->SetInput(text.c_str());
-    vtkTextProperty * tprop = caption->GetTextProperty();
-    tprop->SetFontSize(15);
-
-    double colorRGB[3];
-    lookupTable->GetColor(color, colorRGB);
-    tprop->SetColor(colorRGB);
-
-    caption->SetPosition(center);
-    assemblyCaptions->AddPart(caption);
+    Caption caption;
+    caption.position[0] = center[0];
+    caption.position[1] = center[1];
+    caption.position[2] = center[2];
+    caption.text        = text;
+    caption.priority    = priority;
+    lookupTable->GetColor(color, caption.color);
+    captions.push_back(caption);
 }
 
 void FacilityGeometry::showGeometryLabels(int status)
 {
-    vtkProp3DCollection * col = assemblyCaptions->GetParts();
-    assemblyCaptions->GetActors(col);
+    captionsVisibility = status;
+}
 
-    for(int i = 0; i < col->GetNumberOfItems(); i++) {
-        ((vtkActor *) col->GetItemAsObject(i))->SetVisibility(status);
-    }
-    assemblyCaptions->Modified();
+bool FacilityGeometry::getGeometryLabelsVisibility() const
+{
+    return captionsVisibility;
 }
 
 const std::string & FacilityGeometry::GetDescription() const
@@ -30,7 +30,9 @@
  */
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
 // forwarded classes
 class vtkPolyData;
@@ -40,7 +42,7 @@ class vtkAssembly;
 class vtkDataSet;
 class vtkLookupTable;
 class LinePlotter2D;
-class vtkActor2DCollection;
+class BoxPlotter;
 
 class FacilityGeometry
 {
@@ -58,6 +60,17 @@ public:
         BOX       //!< BOX defined by centre, length, width and height
     };
 
+    /// Caption of a geometry element. The captions of all subrooms are plotted together by the
+    /// GeometryFactory, so overlapping captions of different subrooms can be skipped.
+    struct Caption {
+        double position[3];
+        std::string text;
+        /// RGB in [0, 1]
+        double color[3];
+        /// captions with a higher priority are placed first
+        int priority;
+    };
+
     FacilityGeometry(
         const std::string & description,
         const std::string & roomCaption,
@@ -68,9 +81,7 @@ public:
 
     vtkAssembly * getActor3D();
 
-    vtkAssembly * getCaptionsActor();
-
-    vtkActor2DCollection * getCaptions();
+    const std::vector<Caption> & getCaptions() const;
 
     void CreateActors();
 
@@ -195,6 +206,7 @@ public:
     void showFloor(bool status);
     void showObstacles(bool status);
     void showGeometryLabels(int status);
+    bool getGeometryLabelsVisibility() const;
     void showGradientField(bool status);
 
     void setVisibility(bool status);
@@ -208,7 +220,12 @@ private:
     void drawWall(JPoint * p1, JPoint * p2);
     void drawDoor(JPoint * p1, JPoint * p2);
     void addNewElement(double center[3], double orientation, double width, ELEMENT_TYPE type);
-    void addNewElementText(double center[3], double orientation[3], std::string text, double color);
+    void addNewElementText(
+        double center[3],
+        double orientation[3],
+        std::string text,
+        double color,
+        int priority = 0);
 
     // geometry parameters
     double doorThickness;
@@ -228,10 +245,11 @@ private:
     LinePlotter2D * linesPlotter2D;
     vtkAssembly * assembly2D;
 
-    // 3-d parts
+    // 3-d parts, all elements of a kind are merged into a single actor
     // vtkAssembly* assemblyObjects;
-    vtkAssembly * assemblyWalls3D;
-    vtkAssembly * assemblyDoors3D;
+    std::unique_ptr<BoxPlotter> walls3D;
+    std::unique_ptr<BoxPlotter> doors3D;
+    std::unique_ptr<BoxPlotter> steps3D;
     vtkAssembly * assembly3D;
 
     vtkActor * floorActor;
@@ -239,8 +257,8 @@ private:
     vtkActor * gradientFieldActor;
 
     // other parts
-    vtkAssembly * assemblyCaptions;
-    vtkActor2DCollection * captions;
+    std::vector<Caption> captions;
+    bool captionsVisibility = true;
 
     std::string _description;
     std::string _roomCaption;
@@ -2,9 +2,16 @@
 
 #include "FacilityGeometry.h"
 
+#include <vtkActor2D.h>
 #include <vtkAssembly.h>
 #include <vtkRenderer.h>
 
+namespace
+{
+/// Font size of the geometry captions in points
+constexpr int captionFontSize = 15;
+} // namespace
+
 GeometryFactory::GeometryFactory() {}
 
 void GeometryFactory::Init(vtkRenderer * renderer)
@@ -16,6 +23,22 @@ void GeometryFactory::Init(vtkRenderer * renderer)
             renderer->AddActor(subroom.second->getActor3D());
         }
     }
+
+    _captions.clear();
+    for(auto && rooms : _geometryFactory) {
+        for(auto && subroom : rooms.second) {
+            for(auto && caption : subroom.second->getCaptions()) {
+                std::array<double, 3> color{caption.color[0], caption.color[1], caption.color[2]};
+                auto & plotter = _captions[color];
+                if(!plotter) {
+                    plotter = std::make_unique<LabelPlotter>(caption.color, captionFontSize);
+                    renderer->AddActor2D(plotter->getActor());
+                }
+            }
+        }
+    }
+    updateCaptions();
+    updateCaptionVisibility();
 }
 
 void GeometryFactory::Set2D(bool status)
@@ -26,6 +49,8 @@ void GeometryFactory::Set2D(bool status)
                 subroom.second->set2D(status);
         }
     }
+    _shown2D = status;
+    updateCaptionVisibility();
 }
 
 void GeometryFactory::Set3D(bool status)
@@ -36,11 +61,14 @@ void GeometryFactory::Set3D(bool status)
                 subroom.second->set3D(status);
         }
     }
+    _shown3D = status;
+    updateCaptionVisibility();
 }
 
 void GeometryFactory::Clear()
 {
     _geometryFactory.clear();
+    _captions.clear();
     _model.clear();
     _model.setObjectName("");
 }
@@ -173,6 +201,38 @@ void GeometryFactory::ShowGeometryLabels(int status)
                 subroom.second->showGeometryLabels(status);
         }
     }
+    updateCaptions();
+}
+
+void GeometryFactory::updateCaptions()
+{
+    for(auto && plotter : _captions) {
+        plotter.second->Clear();
+    }
+    for(auto && room : _geometryFactory) {
+        for(auto && subroom : room.second) {
+            if(!subroom.second->getVisibility() ||
+               !subroom.second->getGeometryLabelsVisibility()) {
+                continue;
+            }
+            for(auto && caption : subroom.second->getCaptions()) {
+                std::array<double, 3> color{caption.color[0], caption.color[1], caption.color[2]};
+                // plotters are created in Init()
+                auto plotter = _captions.find(color);
+                if(plotter != _captions.end()) {
+                    plotter->second->PlotLabel(caption.position, caption.text, caption.priority);
+                }
+            }
+        }
+    }
+}
+
+void GeometryFactory::updateCaptionVisibility()
+{
+    // the captions are shown in 2D and 3D alike, they used to be part of both assemblies
+    for(auto && plotter : _captions) {
+        plotter.second->SetVisibility(_shown2D || _shown3D);
+    }
 }
 
 bool GeometryFactory::RefreshView()
@@ -253,6 +313,7 @@ void GeometryFactory::UpdateVisibility(int room, int subroom, bool status)
     if(_geometryFactory.count(room)) {
         if(_geometryFactory[room].count(subroom)) {
             _geometryFactory[room][subroom]->setVisibility(status);
+            updateCaptions();
         }
     }
 }
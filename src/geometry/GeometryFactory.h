@@ -1,8 +1,10 @@
 #pragma once
 
 #include "FacilityGeometry.h"
+#include "LabelPlotter.h"
 
 #include <QStandardItemModel>
+#include <array>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -42,7 +44,17 @@ public:
     QStandardItemModel & GetModel();
 
 private:
+    /// Replots the captions of the subrooms showing their captions
+    void updateCaptions();
+    /// Shows the captions as long as the geometry is shown in 2D or 3D
+    void updateCaptionVisibility();
+
     // map a room,subroom id to a geometry element
     std::map<int, std::map<int, std::shared_ptr<FacilityGeometry>>> _geometryFactory;
+    // captions of all subrooms, one plotter per text color
+    std::map<std::array<double, 3>, std::unique_ptr<LabelPlotter>> _captions;
+    // geometry shown as set by Set2D() and Set3D()
+    bool _shown2D{true};
+    bool _shown3D{true};
     QStandardItemModel _model;
 };
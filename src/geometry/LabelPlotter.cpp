@@ -0,0 +1,94 @@
+#include "LabelPlotter.h"
+
+#include <vtkActor2D.h>
+#include <vtkIntArray.h>
+#include <vtkLabelHierarchy.h>
+#include <vtkLabelPlacementMapper.h>
+#include <vtkPointData.h>
+#include <vtkPointSetToLabelHierarchy.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkStringArray.h>
+#include <vtkTextProperty.h>
+
+namespace
+{
+/// Number of labels stored in each node of the hierarchy, the coarse levels seen when zoomed
+/// out hold at most this many labels per node
+constexpr int labelsPerNode = 16;
+/// Fraction of the viewport the placed labels may cover at most
+constexpr double maximumLabelFraction = 0.15;
+} // namespace
+
+LabelPlotter::LabelPlotter(const double color[3], int fontSize) :
+    _points(vtkSmartPointer<vtkPoints>::New()),
+    _labels(vtkSmartPointer<vtkStringArray>::New()),
+    _priorities(vtkSmartPointer<vtkIntArray>::New()),
+    _polyData(vtkSmartPointer<vtkPolyData>::New()),
+    _hierarchy(vtkSmartPointer<vtkPointSetToLabelHierarchy>::New()),
+    _mapper(vtkSmartPointer<vtkLabelPlacementMapper>::New()),
+    _actor(vtkSmartPointer<vtkActor2D>::New())
+{
+    _labels->SetName("labels");
+    _priorities->SetName("priorities");
+
+    _polyData->SetPoints(_points);
+    _polyData->GetPointData()->AddArray(_labels);
+    _polyData->GetPointData()->AddArray(_priorities);
+
+    auto * textProperty = _hierarchy->GetTextProperty();
+    textProperty->SetColor(color[0], color[1], color[2]);
+    textProperty->SetFontSize(fontSize);
+    textProperty->SetJustificationToCentered();
+    textProperty->SetVerticalJustificationToCentered();
+
+    _hierarchy->SetInputData(_polyData);
+    _hierarchy->SetLabelArrayName("labels");
+    _hierarchy->SetPriorityArrayName("priorities");
+    _hierarchy->SetTargetLabelCount(labelsPerNode);
+
+    _mapper->SetInputConnection(_hierarchy->GetOutputPort());
+    // traverse the hierarchy from the coarse to the fine levels, highest priority first, and
+    // stop once the budget is spent instead of trying to place every label
+    _mapper->SetIteratorType(vtkLabelHierarchy::QUEUE);
+    _mapper->SetMaximumLabelFraction(maximumLabelFraction);
+    _mapper->PlaceAllLabelsOff();
+    // labels are drawn on top, walls in 3D would hide most of them
+    _mapper->UseDepthBufferOff();
+
+    _actor->SetMapper(_mapper);
+}
+
+void LabelPlotter::PlotLabel(const double position[3], const std::string & text, int priority)
+{
+    _points->InsertNextPoint(position);
+    _labels->InsertNextValue(text);
+    _priorities->InsertNextValue(priority);
+    _polyData->Modified();
+}
+
+void LabelPlotter::Clear()
+{
+    _points->Reset();
+    _labels->Reset();
+    _priorities->Reset();
+    _points->Modified();
+    _polyData->Modified();
+}
+
+void LabelPlotter::SetInputData(vtkPolyData * polyData, const char * labelArray)
+{
+    _hierarchy->SetInputData(polyData);
+    // without the priority array all labels have the same priority
+    _hierarchy->SetLabelArrayName(labelArray);
+}
+
+void LabelPlotter::SetVisibility(bool status)
+{
+    _actor->SetVisibility(status);
+}
+
+vtkActor2D * LabelPlotter::getActor() const
+{
+    return _actor;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vtkSmartPointer.h>
+
+class vtkActor2D;
+class vtkIntArray;
+class vtkLabelPlacementMapper;
+class vtkPointSetToLabelHierarchy;
+class vtkPoints;
+class vtkPolyData;
+class vtkStringArray;
+
+/// Plots many text labels, e.g. all captions of the geometry or the ids of the agents, with a
+/// single actor. The labels are sorted into a spatial hierarchy and placed in screen space:
+/// labels overlapping an already placed one are skipped, labels with a higher priority are
+/// placed first, and the total area covered by labels is bounded by a budget. Compared to one
+/// text actor per label, the cost of a frame depends on the number of labels visible on screen
+/// and not on the number of labels in the scene.
+class LabelPlotter
+{
+    vtkSmartPointer<vtkPoints> _points;
+    vtkSmartPointer<vtkStringArray> _labels;
+    vtkSmartPointer<vtkIntArray> _priorities;
+    vtkSmartPointer<vtkPolyData> _polyData;
+    vtkSmartPointer<vtkPointSetToLabelHierarchy> _hierarchy;
+    vtkSmartPointer<vtkLabelPlacementMapper> _mapper;
+    vtkSmartPointer<vtkActor2D> _actor;
+
+public:
+    /// @param color RGB in [0, 1] of the text
+    /// @param fontSize of the text in points
+    LabelPlotter(const double color[3], int fontSize);
+    ~LabelPlotter() = default;
+
+    LabelPlotter(const LabelPlotter &) = delete;
+    LabelPlotter & operator=(const LabelPlotter &) = delete;
+
+    /// Adds a label
+    /// @param position of the label in world coordinates
+    /// @param text of the label
+    /// @param priority labels with a higher priority are placed first
+    void PlotLabel(const double position[3], const std::string & text, int priority);
+
+    /// Removes all labels added with PlotLabel()
+    void Clear();
+
+    /// Labels the points of 'polyData' instead of the labels added with PlotLabel(), e.g. the
+    /// agents of the current frame. The hierarchy is rebuilt whenever 'polyData' is modified.
+    /// @param polyData to label, needs to outlive the plotter
+    /// @param labelArray name of the point data array holding the labels, numbers are converted
+    void SetInputData(vtkPolyData * polyData, const char * labelArray);
+
+    void SetVisibility(bool status);
+
+    /// @return the actor rendering all labels
+    vtkActor2D * getActor() const;
+};
@@ -67,7 +67,7 @@ void PointPlotter::PlotPoint(const glm::dvec3 & pos, double color)
         colors->InsertTuple1(nextPointID, color / 255.0);
     }
 
-    pts->InsertPoint(nextPointID, pos.x, pos.y, pos.x);
+    pts->InsertPoint(nextPointID, pos.x, pos.y, pos.z);
     pts->Modified();
     colors->Modified();
 }
@@ -45,6 +45,7 @@
 #include "CLI.h"
 #include "Log.h"
 #include "MainWindow.h"
+#include "OffscreenRenderer.h"
 
 #include <QApplication>
 #include <QDir>
@@ -62,6 +63,14 @@
 
 int main(int argc, char * argv[])
 {
+    if(isRenderRequested(argc, argv)) {
+        // no window is opened, a core application does not need a display
+        QCoreApplication a(argc, argv);
+        setlocale(LC_NUMERIC, "C");
+        const auto arguments = handleParserArguments();
+        return renderOffscreen(arguments.path.value(), arguments.render.value());
+    }
+
     QSurfaceFormat::setDefaultFormat(QVTKOpenGLNativeWidget::defaultFormat());
 
     QApplication a(argc, argv);
@@ -73,9 +82,9 @@ int main(int argc, char * argv[])
     // force the application to first looks for privated libs
     a.addLibraryPath(QApplication::applicationDirPath() + QDir::separator() + "lib");
 
-    std::optional<std::filesystem::path> commandLinePath = handleParserArguments();
+    const auto arguments = handleParserArguments();
 
-    MainWindow w(nullptr, commandLinePath);
+    MainWindow w(nullptr, arguments.path);
     w.show();
     return a.exec();
 }